@@ -0,0 +1,250 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/gpio_filter.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include "button_input.h"
+
+static const char *TAG = "button_input";
+
+#define BUTTON_RING_MASK (BUTTON_RING_SIZE - 1)
+
+// Prsten sa jednim piscem (ISR) i jednim čitaocem (zadatak), bez zaključavanja
+static button_edge_t ring[BUTTON_RING_SIZE];
+static uint32_t ring_head = 0; // Piše samo ISR
+static uint32_t ring_tail = 0; // Piše samo zadatak
+static TaskHandle_t consumer_task = NULL;
+static int isr_core = -1; // Jezgra na kojoj radi ISR tipki
+
+// Sintetičke ivice (stres test) maskiraju prekide dok pišu, pa ISR vidi jednog pisca
+static portMUX_TYPE inject_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Zadnji nivo koji je ISR stavio u prsten, po pinu (tipke su na pull-up)
+static uint8_t last_level[GPIO_NUM_MAX];
+
+// Softverski filter kad hardverski ne može primijeniti traženi prozor (0 = isključen)
+static uint32_t software_window_ns = 0;
+
+// Statistika ISR-a
+static uint32_t raw_interrupts = 0;
+static uint32_t noise_interrupts = 0; // Prekidi bez promjene nivoa (smetnja kraća od čitanja pina)
+static uint32_t accepted_presses = 0;
+static uint32_t injected_edges = 0;
+static uint32_t dropped_edges = 0;
+static uint32_t ring_high_water = 0; // Najviše ivica koje su čekale zadatak
+static uint32_t isr_max_ns = 0;
+
+// Dodaj ivicu u prsten; poziva se samo iz prekida na jezgri isr_core
+static inline bool IRAM_ATTR ring_push(const button_edge_t *edge, BaseType_t *higher_priority_task_woken)
+{
+    uint32_t head = ring_head;
+    uint32_t used = head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    if (used >= BUTTON_RING_SIZE)
+    {
+        dropped_edges++;
+        return false;
+    }
+
+    ring[head & BUTTON_RING_MASK] = *edge;
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+    if (used + 1 > ring_high_water)
+    {
+        ring_high_water = used + 1;
+    }
+    vTaskNotifyGiveFromISR(consumer_task, higher_priority_task_woken);
+    return true;
+}
+
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    int pin = (int)arg;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    button_edge_t edge = {
+        .time_us = esp_timer_get_time(),
+        .pin = (uint8_t)pin,
+        .level = (uint8_t)gpio_get_level(pin),
+    };
+
+    // Novi nivo mora trajati cijeli prozor od ulaska u ISR, inače je impuls bio kraći od prozora
+    if (software_window_ns > 0 && edge.level != last_level[pin])
+    {
+        uint32_t window_cycles = software_window_ns * esp_rom_get_cpu_ticks_per_us() / 1000;
+        while (esp_cpu_get_cycle_count() - start_cycles < window_cycles)
+        {
+        }
+        if (gpio_get_level(pin) != edge.level)
+        {
+            edge.level = last_level[pin]; // Broji se kao smetnja ispod
+        }
+    }
+
+    // Okreni okidač na suprotan nivo, tako svaki prekid odgovara jednoj ivici
+    gpio_set_intr_type(pin, edge.level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    raw_interrupts++;
+
+    // Impuls se već vratio prije čitanja - ne budi zadatak za ništa
+    if (edge.level == last_level[pin])
+    {
+        noise_interrupts++;
+    }
+    else
+    {
+        last_level[pin] = edge.level;
+        ring_push(&edge, &higher_priority_task_woken);
+    }
+
+    uint32_t elapsed_ns = (esp_cpu_get_cycle_count() - start_cycles) * 1000 / esp_rom_get_cpu_ticks_per_us();
+    if (elapsed_ns > isr_max_ns)
+    {
+        isr_max_ns = elapsed_ns;
+    }
+
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+esp_err_t button_input_start(const int *pins, int pin_count)
+{
+    consumer_task = xTaskGetCurrentTaskHandle();
+    isr_core = xPortGetCoreID();
+
+    // ISR i prsten su u IRAM-u (gpio funkcije preko CONFIG_GPIO_CTRL_FUNC_IN_IRAM), pa tipke rade i dok se piše flash
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return err;
+    }
+
+    for (int i = 0; i < pin_count; i++)
+    {
+        last_level[pins[i]] = 1;
+        err = gpio_isr_handler_add(pins[i], button_isr_handler, (void *)pins[i]);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t button_input_enable_glitch_filter(const int *pins, int pin_count, uint32_t window_ns)
+{
+    for (int i = 0; i < pin_count; i++)
+    {
+        gpio_glitch_filter_handle_t filter = NULL;
+        esp_err_t err;
+#if SOC_GPIO_FLEX_GLITCH_FILTER_NUM > 0
+        // Flex filter: impulsi kraći od prozora se ne vide, pa ne prave ni prekid
+        gpio_flex_glitch_filter_config_t filter_config = {
+            .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+            .gpio_num = pins[i],
+            .window_width_ns = window_ns,
+            .window_thres_ns = window_ns,
+        };
+        err = gpio_new_flex_glitch_filter(&filter_config, &filter);
+#elif SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+        // Pin filter ima fiksni prozor od dva takta, window_ns se ne može primijeniti
+        gpio_pin_glitch_filter_config_t filter_config = {
+            .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+            .gpio_num = pins[i],
+        };
+        err = gpio_new_pin_glitch_filter(&filter_config, &filter);
+#else
+        err = ESP_OK; // Samo softverski filter ispod
+#endif
+#if SOC_GPIO_FLEX_GLITCH_FILTER_NUM > 0 || SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+        if (err == ESP_OK)
+        {
+            err = gpio_glitch_filter_enable(filter);
+        }
+#endif
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+
+#if SOC_GPIO_FLEX_GLITCH_FILTER_NUM > 0
+    ESP_LOGI(TAG, "Glitch filter enabled, %lu ns window", (unsigned long)window_ns);
+#else
+    // ESP32-S3 ima samo pin filter (dva takta), pa širinu provjerava ISR
+    software_window_ns = window_ns;
+    ESP_LOGW(TAG, "No hardware filter with a %lu ns window, ISR checks the pulse width in software",
+             (unsigned long)window_ns);
+#endif
+    return ESP_OK;
+}
+
+void button_input_count_press(void)
+{
+    accepted_presses++;
+}
+
+bool IRAM_ATTR button_input_inject_from_isr(int pin, uint8_t level, uint8_t flags, BaseType_t *higher_priority_task_woken)
+{
+    if (consumer_task == NULL || xPortGetCoreID() != isr_core)
+    {
+        return false;
+    }
+
+    button_edge_t edge = {
+        .time_us = esp_timer_get_time(),
+        .pin = (uint8_t)pin,
+        .level = level,
+        .flags = flags,
+    };
+
+    portENTER_CRITICAL_ISR(&inject_lock);
+    injected_edges++;
+    bool queued = ring_push(&edge, higher_priority_task_woken);
+    portEXIT_CRITICAL_ISR(&inject_lock);
+    return queued;
+}
+
+int button_input_core(void)
+{
+    return isr_core;
+}
+
+void button_input_get_stats(button_input_stats_t *stats)
+{
+    stats->interrupts = raw_interrupts;
+    stats->noise = noise_interrupts;
+    stats->accepted_presses = accepted_presses;
+    stats->injected = injected_edges;
+    stats->dropped = dropped_edges;
+    stats->ring_high_water = ring_high_water;
+}
+
+void button_input_clear_high_water(void)
+{
+    ring_high_water = 0;
+}
+
+bool button_input_pop(button_edge_t *edge)
+{
+    uint32_t tail = ring_tail;
+    if (tail == __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    *edge = ring[tail & BUTTON_RING_MASK];
+    __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void button_input_log_stats(void)
+{
+    ESP_LOGI(TAG, "%lu interrupts (%lu noise) for %lu accepted presses, %lu injected, %lu dropped edges, "
+                  "ring high-water %lu/%d, worst ISR time %lu ns",
+             (unsigned long)raw_interrupts, (unsigned long)noise_interrupts, (unsigned long)accepted_presses,
+             (unsigned long)injected_edges, (unsigned long)dropped_edges,
+             (unsigned long)ring_high_water, BUTTON_RING_SIZE, (unsigned long)isr_max_ns);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Veličina prstena ivica između ISR-a i zadatka (mora biti stepen dvojke)
+#define BUTTON_RING_SIZE 32
+
+// Sintetička ivica koja preskače debounce i cooldown zauzimanja (stres test u capture načinu)
+#define BUTTON_EDGE_DIRECT (1 << 0)
+
+/**
+ * @brief Jedna ivica na pinu tipke, kako ju je vidio ISR
+ */
+typedef struct
+{
+    int64_t time_us; // esp_timer vrijeme ulaska u ISR
+    uint8_t pin;
+    uint8_t level; // Nivo pina nakon ivice (0 = pritisnuto, tipke su na pull-up)
+    uint8_t flags; // BUTTON_EDGE_*, 0 za prave ivice
+} button_edge_t;
+
+typedef struct
+{
+    uint32_t interrupts;       // Prekidi sa pinova tipki
+    uint32_t noise;            // Prekidi koje je ISR odbacio jer se nivo nije promijenio
+    uint32_t accepted_presses; // Pritisci koji su prošli debounce
+    uint32_t injected;         // Sintetičke ivice iz button_input_inject_from_isr()
+    uint32_t dropped;          // Ivice izgubljene jer je prsten bio pun
+    uint32_t ring_high_water;  // Najviše ivica koje su istovremeno čekale zadatak
+} button_input_stats_t;
+
+/**
+ * @brief Instaliraj prekide tipki i budi trenutni zadatak na svaku ivicu
+ *
+ * Prekidi se obrađuju na jezgri sa koje se ovo pozove. ISR samo zapiše
+ * {pin, nivo, vrijeme} u prsten i probudi zadatak sa vTaskNotifyGiveFromISR(),
+ * pa zadatak treba čekati sa ulTaskNotifyTake() i isprazniti prsten.
+ * Pinovi moraju već biti konfigurisani sa prekidom na nivo.
+ */
+esp_err_t button_input_start(const int *pins, int pin_count);
+
+/**
+ * @brief Uključi hardverski filter smetnji na pinovima tipki
+ *
+ * Koristi flex glitch filter sa prozorom window_ns ako ga čip ima. Inače
+ * uključi pin glitch filter (fiksni prozor od dva takta, ako postoji), a
+ * ISR nakon svake promjene nivoa čeka window_ns od ulaska u prekid i
+ * ponovo čita pin; impuls koji se do tad vratio se broji kao smetnja.
+ * Zbog kašnjenja prekida odbace se i impulsi malo duži od window_ns.
+ * Mora se pozvati prije button_input_start().
+ *
+ * @return Grešku drajvera ako se hardverski filter ne može uključiti
+ */
+esp_err_t button_input_enable_glitch_filter(const int *pins, int pin_count, uint32_t window_ns);
+
+/**
+ * @brief Zabilježi pritisak koji je prošao debounce (za omjer prekida i pritisaka)
+ */
+void button_input_count_press(void);
+
+/**
+ * @brief Ubaci sintetičku ivicu istim putem kao pravi ISR (za stres test)
+ *
+ * Smije se pozvati samo iz prekida na jezgri button_input_core(), tako
+ * prsten i dalje ima jednog pisca u svakom trenutku.
+ *
+ * @param flags BUTTON_EDGE_* zastavice koje ivica nosi do zadatka
+ * @return false ako je prsten pun ili je pozvano sa pogrešne jezgre
+ */
+bool button_input_inject_from_isr(int pin, uint8_t level, uint8_t flags, BaseType_t *higher_priority_task_woken);
+
+/**
+ * @return Jezgra na kojoj se obrađuju prekidi tipki, ili -1 prije button_input_start()
+ */
+int button_input_core(void);
+
+/**
+ * @brief Kopiraj brojače ulaza
+ */
+void button_input_get_stats(button_input_stats_t *stats);
+
+/**
+ * @brief Počni iznova mjeriti najveću popunjenost prstena
+ */
+void button_input_clear_high_water(void);
+
+/**
+ * @brief Uzmi najstariju ivicu iz prstena
+ *
+ * @return false ako je prsten prazan
+ */
+bool button_input_pop(button_edge_t *edge);
+
+/**
+ * @brief Ispiši broj prekida, izgubljenih ivica i najduže trajanje ISR-a
+ */
+void button_input_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+#include "driver/uart.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "console.h"
+#include "hill_link.h"
+#include "latency.h"
+#include "notify_format.h"
+#include "stress.h"
+
+static const char *TAG = "console";
+
+// Broj ivica na RX liniji koji budi čip iz light sleep-a (prvi znakovi se gube)
+#define CONSOLE_WAKEUP_THRESHOLD 3
+
+// Trajanje stres testa ako nije zadano
+#define STRESS_DEFAULT_DURATION_S 10
+
+// Broj formatiranih poruka po načinu u benchmark-u ako nije zadan
+#define BENCH_DEFAULT_ITERATIONS 10000
+#define BENCH_MAX_ITERATIONS 1000000
+
+// Vrijeme do zajedničkog početka ako nije zadano
+#define STARTALL_DEFAULT_DELAY_S 5
+
+static int cmd_latency(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        latency_reset();
+        printf("Latency histograms cleared\n");
+        return 0;
+    }
+    if (argc != 1)
+    {
+        printf("Usage: latency [reset]\n");
+        return 1;
+    }
+    latency_print();
+    return 0;
+}
+
+static int cmd_stress(int argc, char **argv)
+{
+    bool direct = argc == 4 && strcmp(argv[3], "direct") == 0;
+    if (argc < 2 || argc > 4 || (argc == 4 && !direct))
+    {
+        printf("Usage: stress <captures_per_second> [seconds] [direct]\n");
+        return 1;
+    }
+
+    uint32_t rate = strtoul(argv[1], NULL, 10);
+    uint32_t duration_s = argc >= 3 ? strtoul(argv[2], NULL, 10) : STRESS_DEFAULT_DURATION_S;
+    esp_err_t err = stress_run(rate, duration_s, direct);
+    if (err == ESP_ERR_INVALID_ARG)
+    {
+        printf("Rate must be 1-%d captures/s and duration 1-%d s\n", STRESS_MAX_RATE, STRESS_MAX_DURATION_S);
+        return 1;
+    }
+    if (err != ESP_OK)
+    {
+        printf("Stress test unavailable: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_bench(int argc, char **argv)
+{
+    if (argc > 2)
+    {
+        printf("Usage: bench [iterations]\n");
+        return 1;
+    }
+
+    uint32_t iterations = argc == 2 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_ITERATIONS;
+    if (iterations == 0 || iterations > BENCH_MAX_ITERATIONS)
+    {
+        printf("Iterations must be 1-%d\n", BENCH_MAX_ITERATIONS);
+        return 1;
+    }
+    notify_format_benchmark(iterations);
+    return 0;
+}
+
+static int cmd_startall(int argc, char **argv)
+{
+    if (argc > 2)
+    {
+        printf("Usage: startall [seconds]\n");
+        return 1;
+    }
+
+    uint32_t delay_s = argc == 2 ? strtoul(argv[1], NULL, 10) : STARTALL_DEFAULT_DELAY_S;
+    esp_err_t err = hill_link_start_all(delay_s * 1000);
+    if (err == ESP_ERR_INVALID_ARG)
+    {
+        printf("Delay must be at least %d ms\n", HILL_START_MIN_DELAY_MS);
+        return 1;
+    }
+    if (err != ESP_OK)
+    {
+        printf("Cannot start all hills: %s (only the aggregator can)\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+void console_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "koth>";
+
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create console: %s", esp_err_to_name(err));
+        return;
+    }
+
+    esp_console_register_help_command();
+
+    const esp_console_cmd_t latency_cmd = {
+        .command = "latency",
+        .help = "Print button-to-display latency histograms, or clear them with 'latency reset'",
+        .func = &cmd_latency,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&latency_cmd));
+
+    const esp_console_cmd_t stress_cmd = {
+        .command = "stress",
+        .help = "Inject synthetic button edges and report drops, queue depth and CPU load. Edges go through "
+                "debounce and capture cooldown like real presses; 'direct' skips both so every pair is a capture",
+        .hint = "<captures_per_second> [seconds] [direct]",
+        .func = &cmd_stress,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&stress_cmd));
+
+    const esp_console_cmd_t bench_cmd = {
+        .command = "bench",
+        .help = "Time notification formatting: JSON writer, equivalent snprintf and the text message",
+        .hint = "[iterations]",
+        .func = &cmd_bench,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&bench_cmd));
+
+    const esp_console_cmd_t startall_cmd = {
+        .command = "startall",
+        .help = "Start the game on every synchronized hill at the same moment (aggregator only)",
+        .hint = "[seconds]",
+        .func = &cmd_startall,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&startall_cmd));
+
+    // Bez ovoga konzola ne reaguje dok uređaj spava između mečeva
+    uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, CONSOLE_WAKEUP_THRESHOLD);
+    esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM);
+
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+}
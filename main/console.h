@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pokreni REPL na serijskoj konzoli i registruj komande
+ *
+ * Komande:
+ * - latency         ispiši histograme kašnjenja od tipke do prikaza
+ * - latency reset   obriši histograme (između mečeva)
+ * - stress R [S] [direct]
+ *                   ubacuj R zauzimanja u sekundi kroz put tipki S sekundi;
+ *                   sa direct preskače debounce i pauzu između zauzimanja
+ * - bench [N]       izmjeri formatiranje poruka (JSON writer, snprintf, tekst)
+ * - startall [S]    pokreni igru na svim brdima za S sekundi (samo agregator)
+ */
+void console_start(void);
+
+#ifdef __cplusplus
+}
+#endif
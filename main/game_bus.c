@@ -0,0 +1,124 @@
+#include "game_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "game_bus";
+
+struct game_bus_sub
+{
+    const char *name;
+    TaskHandle_t task;
+    uint32_t mask;
+    uint32_t wakeups;      // Ukupan broj buđenja iz game_bus_wait()
+    uint32_t last_wakeups; // Stanje brojača pri zadnjem ispisu statistike
+
+    // Kašnjenje raspoređivanja: od prve neobrađene objave do buđenja zadatka
+    uint32_t pending_since_us; // Donjih 32 bita esp_timer vremena, 0 = ništa ne čeka
+    uint32_t max_latency_us;   // Najgore kašnjenje od zadnjeg ispisa statistike
+};
+
+static game_bus_sub_t subscribers[GAME_BUS_MAX_SUBSCRIBERS];
+static int subscriber_count = 0;
+static portMUX_TYPE subscribe_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t last_stats_us = 0;
+
+game_bus_sub_t *game_bus_subscribe(const char *name, uint32_t mask)
+{
+    game_bus_sub_t *sub = NULL;
+
+    portENTER_CRITICAL(&subscribe_lock);
+    if (subscriber_count < GAME_BUS_MAX_SUBSCRIBERS)
+    {
+        sub = &subscribers[subscriber_count];
+        sub->name = name;
+        sub->task = xTaskGetCurrentTaskHandle();
+        sub->mask = mask;
+        sub->wakeups = 0;
+        sub->last_wakeups = 0;
+        sub->pending_since_us = 0;
+        sub->max_latency_us = 0;
+        // Objavi novi zapis tek kad je popunjen, publish ga čita bez zaključavanja
+        __atomic_store_n(&subscriber_count, subscriber_count + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&subscribe_lock);
+
+    if (sub == NULL)
+    {
+        ESP_LOGE(TAG, "Too many subscribers, %s will not receive events", name);
+    }
+    return sub;
+}
+
+// Zapamti vrijeme objave, osim ako pretplatnik već ima neobrađen događaj
+static inline void mark_pending(game_bus_sub_t *sub, uint32_t now_us)
+{
+    uint32_t expected = 0;
+    __atomic_compare_exchange_n(&sub->pending_since_us, &expected, now_us ? now_us : 1,
+                                false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+void game_bus_publish(uint32_t events)
+{
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    int count = __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t relevant = events & subscribers[i].mask;
+        if (relevant)
+        {
+            mark_pending(&subscribers[i], now_us);
+            xTaskNotify(subscribers[i].task, relevant, eSetBits);
+        }
+    }
+}
+
+uint32_t game_bus_wait(game_bus_sub_t *sub, TickType_t timeout)
+{
+    uint32_t events = 0;
+
+    xTaskNotifyWait(0, UINT32_MAX, &events, timeout);
+    if (sub != NULL)
+    {
+        sub->wakeups++;
+
+        uint32_t since_us = __atomic_exchange_n(&sub->pending_since_us, 0, __ATOMIC_RELAXED);
+        if (events && since_us)
+        {
+            uint32_t latency_us = (uint32_t)esp_timer_get_time() - since_us;
+            if (latency_us > sub->max_latency_us)
+            {
+                sub->max_latency_us = latency_us;
+            }
+        }
+    }
+    return events;
+}
+
+void game_bus_log_stats(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed_us = now - last_stats_us;
+    int count = __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE);
+
+    if (elapsed_us <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        game_bus_sub_t *sub = &subscribers[i];
+        uint32_t wakeups = sub->wakeups;
+        uint32_t delta = wakeups - sub->last_wakeups;
+        sub->last_wakeups = wakeups;
+
+        // Stotinke buđenja u sekundi, da ne trebamo float u formatiranju
+        uint32_t centi_per_second = (uint32_t)((int64_t)delta * 100 * 1000000 / elapsed_us);
+        ESP_LOGI(TAG, "%-8s %lu.%02lu wakeups/s, worst wake latency %lu us", sub->name,
+                 (unsigned long)(centi_per_second / 100), (unsigned long)(centi_per_second % 100),
+                 (unsigned long)sub->max_latency_us);
+        sub->max_latency_us = 0;
+    }
+    last_stats_us = now;
+}
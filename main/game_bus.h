@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Događaji igre - svaki je jedan bit u notifikaciji zadatka
+#define GAME_EVT_START (1 << 0)   // Igra je pokrenuta
+#define GAME_EVT_CAPTURE (1 << 1) // Drugi tim je zauzeo brdo
+#define GAME_EVT_HALFWAY (1 << 2) // Pola vremena je prošlo
+#define GAME_EVT_TICK (1 << 3)    // Prošla je jedna sekunda igre
+#define GAME_EVT_FINISH (1 << 4)  // Vrijeme je isteklo
+#define GAME_EVT_RESET (1 << 5)   // Igra je vraćena u GAME_OFF
+#define GAME_EVT_WIFI (1 << 6)    // Promijenio se status Wi-Fi veze
+#define GAME_EVT_HOLD (1 << 7)    // Tim je počeo ili prestao držati tipku
+
+#define GAME_BUS_MAX_SUBSCRIBERS 8
+
+typedef struct game_bus_sub game_bus_sub_t;
+
+/**
+ * @brief Prijavi trenutni zadatak na događaje iz maske
+ *
+ * Zadatak nakon toga čeka događaje sa game_bus_wait(). Bitovi se isporučuju
+ * preko notifikacije zadatka, pa ih ne smije koristiti za nešto drugo.
+ */
+game_bus_sub_t *game_bus_subscribe(const char *name, uint32_t mask);
+
+/**
+ * @brief Pošalji događaje svim zadacima koji su na njih prijavljeni
+ */
+void game_bus_publish(uint32_t events);
+
+/**
+ * @brief Blokiraj dok ne stigne neki od prijavljenih događaja
+ *
+ * @return Bitovi događaja koji su stigli, ili 0 ako je istekao timeout
+ */
+uint32_t game_bus_wait(game_bus_sub_t *sub, TickType_t timeout);
+
+/**
+ * @brief Ispiši broj buđenja u sekundi i najgore kašnjenje buđenja
+ *
+ * Kašnjenje se mjeri od objave događaja do povratka iz game_bus_wait(),
+ * i resetuje se nakon svakog ispisa.
+ */
+void game_bus_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
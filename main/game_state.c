@@ -0,0 +1,48 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "game_state.h"
+
+// Živo stanje; čitaoci ga kopiraju samo kad je sekvenca parna i nepromijenjena
+static game_snapshot_t live_state = {
+    .state = GAME_OFF,
+    .team = TEAM_NONE,
+    .current_game_time = 0,
+    .hold_team = TEAM_NONE,
+    .hold_start_us = 0,
+    .commit_edge_us = 0,
+    .tick_us = 0,
+};
+static uint32_t sequence = 0;
+
+// Pisci su ulazni zadatak, sat igre i esp_timer zadatak (zajednički početak), moguće na različitim jezgrama
+static portMUX_TYPE write_lock = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t game_state_read(game_snapshot_t *out)
+{
+    uint32_t before;
+    uint32_t after;
+
+    do
+    {
+        before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        memcpy(out, &live_state, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+
+    return before >> 1;
+}
+
+game_snapshot_t *game_state_write_begin(void)
+{
+    portENTER_CRITICAL_SAFE(&write_lock);
+    __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return &live_state;
+}
+
+void game_state_write_end(void)
+{
+    __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL_SAFE(&write_lock);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include "teams.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Enumeracije
+typedef enum
+{
+    GAME_OFF,
+    GAME_PLAYING,
+    GAME_FINISHED
+} GameState;
+
+/**
+ * @brief Jedno konzistentno stanje igre
+ *
+ * Pisci ga mijenjaju samo između game_state_write_begin() i
+ * game_state_write_end(), a čitaoci uvijek dobiju kopiju koja nije
+ * uhvaćena usred promjene.
+ */
+typedef struct
+{
+    GameState state;
+    team_id_t team;        // Tim koji drži brdo, ili TEAM_NONE
+    int current_game_time; // Sekunde od početka igre
+    team_id_t hold_team;   // Tim koji trenutno drži tipku (hold-to-capture), ili TEAM_NONE
+    int64_t hold_start_us; // Vrijeme pritiska tipke tima hold_team
+    int64_t commit_edge_us; // Vrijeme ivice tipke koja je izazvala zadnju promjenu stanja
+    int64_t start_us;       // esp_timer vrijeme početka igre; sekunde igre se broje od njega
+    int64_t tick_us;        // esp_timer vrijeme zadnjeg pomaka sata igre (ili početka igre)
+    uint16_t hold_seconds[MAX_TEAMS]; // Koliko je sekundi svaki tim držao brdo u ovoj igri
+} game_snapshot_t;
+
+/**
+ * @brief Kopiraj trenutno stanje igre
+ *
+ * Ne zaključava ništa; ako pisac mijenja stanje za vrijeme kopiranja,
+ * kopiranje se ponavlja (seqlock).
+ *
+ * @return Generacija stanja, raste sa svakom objavljenom promjenom
+ */
+uint32_t game_state_read(game_snapshot_t *out);
+
+/**
+ * @brief Započni promjenu stanja igre
+ *
+ * Zove se samo iz zadataka (nije u IRAM-u). Između begin i end se ne smije
+ * blokirati, logovati niti slati u redove - samo mijenjati polja.
+ *
+ * @return Pokazivač na živo stanje, važi do game_state_write_end()
+ */
+game_snapshot_t *game_state_write_begin(void);
+
+/**
+ * @brief Objavi promjenu započetu sa game_state_write_begin()
+ */
+void game_state_write_end(void);
+
+#ifdef __cplusplus
+}
+#endif
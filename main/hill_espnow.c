@@ -0,0 +1,139 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_timer.h"
+#include "hill_proto.h"
+#include "hill_transport.h"
+
+static const char *TAG = "hill_espnow";
+
+// Okviri koji čekaju zadatak; ESP-NOW callback radi u Wi-Fi zadatku i ne smije čekati
+#define HILL_ESPNOW_QUEUE_SIZE 8
+
+typedef struct
+{
+    int64_t received_us; // U callback-u, prije čekanja u redu
+    uint8_t length;
+    uint8_t data[HILL_FRAME_MAX];
+} hill_espnow_frame_t;
+
+static const uint8_t broadcast_address[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+static QueueHandle_t received = NULL;
+// Okviri se šalju i potvrđuju po redu, pa je vrijeme poznato tek kad stigne potvrda zadnjeg
+static portMUX_TYPE sent_lock = portMUX_INITIALIZER_UNLOCKED;
+static int in_flight = 0;
+static int64_t last_sent_us = 0;
+
+// Zove se kad je radio završio slanje; vrijeme zadnjeg okvira ide u sljedeći beacon
+static void on_sent(const uint8_t *mac_address, esp_now_send_status_t status)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&sent_lock);
+    if (in_flight > 0 && --in_flight == 0)
+    {
+        last_sent_us = now;
+    }
+    portEXIT_CRITICAL(&sent_lock);
+}
+
+static void on_receive(const esp_now_recv_info_t *info, const uint8_t *data, int length)
+{
+    hill_espnow_frame_t frame;
+    frame.received_us = esp_timer_get_time();
+    if (length <= 0 || length > sizeof(frame.data))
+    {
+        return;
+    }
+    frame.length = length;
+    memcpy(frame.data, data, length);
+    // Ako zadatak kasni, novi okvir se odbacuje; sljedeći stiže za najviše sekundu
+    xQueueSend(received, &frame, 0);
+}
+
+// Radi na kanalu na kojem je Wi-Fi stanica, pa sva brda moraju biti na istom kanalu
+static int espnow_init(void)
+{
+    received = xQueueCreate(HILL_ESPNOW_QUEUE_SIZE, sizeof(hill_espnow_frame_t));
+    if (received == NULL)
+    {
+        return -1;
+    }
+
+    esp_err_t err = esp_now_init();
+    if (err == ESP_OK)
+    {
+        err = esp_now_register_recv_cb(on_receive);
+    }
+    if (err == ESP_OK)
+    {
+        err = esp_now_register_send_cb(on_sent);
+    }
+    if (err == ESP_OK)
+    {
+        esp_now_peer_info_t peer = {
+            .channel = 0, // Trenutni kanal
+            .ifidx = WIFI_IF_STA,
+            .encrypt = false,
+        };
+        memcpy(peer.peer_addr, broadcast_address, sizeof(broadcast_address));
+        err = esp_now_add_peer(&peer);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start ESP-NOW: %s", esp_err_to_name(err));
+        return -1;
+    }
+    return 0;
+}
+
+static int espnow_send(const uint8_t *frame, size_t length)
+{
+    // Potvrda ranijeg okvira koja stigne poslije ovoga ne smije postaviti vrijeme
+    portENTER_CRITICAL(&sent_lock);
+    in_flight++;
+    last_sent_us = 0;
+    portEXIT_CRITICAL(&sent_lock);
+
+    if (esp_now_send(broadcast_address, frame, length) != ESP_OK)
+    {
+        portENTER_CRITICAL(&sent_lock);
+        in_flight--;
+        portEXIT_CRITICAL(&sent_lock);
+        return -1;
+    }
+    return 0;
+}
+
+static int64_t espnow_sent_us(void)
+{
+    portENTER_CRITICAL(&sent_lock);
+    int64_t sent_us = last_sent_us;
+    portEXIT_CRITICAL(&sent_lock);
+    return sent_us;
+}
+
+static int espnow_receive(uint8_t *frame, size_t size, int timeout_ms, int64_t *received_us)
+{
+    hill_espnow_frame_t received_frame;
+    if (xQueueReceive(received, &received_frame, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+    {
+        return 0;
+    }
+    if (received_frame.length > size)
+    {
+        return -1;
+    }
+    memcpy(frame, received_frame.data, received_frame.length);
+    *received_us = received_frame.received_us;
+    return received_frame.length;
+}
+
+const hill_transport_t hill_espnow_transport = {
+    .name = "esp-now",
+    .init = espnow_init,
+    .send = espnow_send,
+    .sent_us = espnow_sent_us,
+    .receive = espnow_receive,
+};
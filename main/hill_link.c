@@ -0,0 +1,471 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "game_state.h"
+#include "hill_link.h"
+#include "hill_proto.h"
+#include "hill_sync.h"
+#include "hill_transport.h"
+#include "notifier.h"
+
+static const char *TAG = "hill_link";
+
+#if defined(HILL_LINK_MEMBER) || defined(HILL_LINK_AGGREGATOR)
+#define HILL_LINK_ENABLED 1
+#endif
+
+#ifdef HILL_LINK_ENABLED
+
+// ESP-NOW ne treba ruter; UDP (-DHILL_TRANSPORT=udp) radi preko Wi-Fi mreže i sa tools/hill_sim.c
+#ifdef HILL_TRANSPORT_UDP
+static const hill_transport_t *transport = &hill_udp_transport;
+#else
+static const hill_transport_t *transport = &hill_espnow_transport;
+#endif
+
+#define HILL_BEACON_MS 1000     // Stanje se šalje i bez promjene, da agregator zna da je brdo živo
+#define HILL_SYNC_INTERVAL_MS 500 // Beacon sata sa agregatora; 16 tačaka pokriva zadnjih 8 s
+#define HILL_POLL_MS 50         // Najduže kašnjenje slanja vlastite promjene
+#define HILL_OFFLINE_MS 5000    // Brdo bez okvira ovoliko dugo je offline
+#define HILL_CONFIRM_MS 50      // Najduže čekanje potvrde beacon-a; bez nje brda preskoče tačku
+#define HILL_CONFIRM_POLL_MS 10 // Jedan tick; potvrda ESP-NOW okvira stiže za oko milisekundu
+
+static int game_time_seconds = 0;
+static char own_name[HILL_NAME_MAX + 1];
+static uint16_t seq = 0;
+static hill_scoreboard_t board;
+#ifdef HILL_LINK_AGGREGATOR
+static portMUX_TYPE board_lock = portMUX_INITIALIZER_UNLOCKED; // Mijenja hill_link zadatak, čita i konzola
+#endif
+
+
+// Zajednički početak: esp_timer zove on_start u lokalno vrijeme početka
+static hill_link_start_fn start_handler = NULL;
+static esp_timer_handle_t start_timer = NULL;
+static volatile int64_t pending_start_us = 0; // Lokalno vrijeme zakazanog početka, 0 ako ga nema
+
+// Zadnji zajednički početak i model sata; čitaju ih sat igre i esp_timer zadatak
+static portMUX_TYPE sync_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t synced_start_local_us = 0;
+static int64_t synced_start_master_us = 0;
+
+#ifdef HILL_LINK_AGGREGATOR
+// Beacon-i sata; agregator je referenca, pa mu je lokalni sat i sat igre
+static uint16_t beacon_seq = 0;
+static bool beacon_unconfirmed = false; // Čeka se vrijeme slanja zadnjeg beacon-a
+static int64_t beacon_sent_us = 0;
+static int64_t last_beacon_us = 0;
+static uint16_t start_id = 0;
+static int64_t start_master_us = 0;
+#else
+// Procjena sata agregatora; mijenja je samo hill_link zadatak, a objavljuje pod sync_lock
+static hill_sync_t sync;
+static hill_clock_model_t clock_model;
+static bool clock_synced = false;
+static volatile bool clear_sync_stats = false; // Statistiku briše zadatak, ne ispis
+static uint16_t handled_start_id = 0;
+static uint32_t missed_starts = 0;
+#endif
+
+// Statistika
+static uint32_t sent = 0;
+static uint32_t send_failures = 0;
+static uint32_t invalid = 0;
+static uint32_t starts = 0;
+static int64_t start_late_us = 0; // Koliko je esp_timer zakasnio sa zadnjim početkom
+
+static void start_timer_callback(void *arg)
+{
+    int64_t start_us = pending_start_us;
+    pending_start_us = 0;
+    start_late_us = esp_timer_get_time() - start_us;
+    starts++;
+
+    portENTER_CRITICAL(&sync_lock);
+    synced_start_local_us = start_us;
+    portEXIT_CRITICAL(&sync_lock);
+
+    if (start_handler != NULL)
+    {
+        start_handler(start_us);
+    }
+}
+
+// Zakaži (ili pomjeri) početak u lokalno vrijeme start_us
+static bool arm_start(int64_t start_us)
+{
+    int64_t delay_us = start_us - esp_timer_get_time();
+    if (delay_us <= 0)
+    {
+        return false;
+    }
+    esp_timer_stop(start_timer); // Nije greška ako timer nije bio pokrenut
+    pending_start_us = start_us;
+    return esp_timer_start_once(start_timer, delay_us) == ESP_OK;
+}
+
+static bool send_frame(const uint8_t *frame, size_t length)
+{
+    if (length > 0 && transport->send(frame, length) == 0)
+    {
+        sent++;
+        return true;
+    }
+    send_failures++;
+    return false;
+}
+
+static void send_state(const game_snapshot_t *game)
+{
+    uint8_t frame[HILL_FRAME_MAX];
+    hill_state_t state = {
+        .seq = seq++,
+        .state = game->state,
+        .team = game->team,
+        .remaining_s = game->state == GAME_PLAYING ? game_time_seconds - game->current_game_time : 0,
+        .team_count = team_count < HILL_TEAMS_MAX ? team_count : HILL_TEAMS_MAX,
+#ifdef HILL_LINK_AGGREGATOR
+        .sync_error_us = 0, // Referenca
+#else
+        .sync_error_us = hill_sync_reported_error_us(&sync),
+#endif
+    };
+    strlcpy(state.name, own_name, sizeof(state.name));
+    memcpy(state.hold_seconds, game->hold_seconds, state.team_count * sizeof(state.hold_seconds[0]));
+
+#ifdef HILL_LINK_AGGREGATOR
+    // Agregator je i sam brdo u tabeli, ali za svoje brdo ne šalje poruke dvaput
+    int index;
+    portENTER_CRITICAL(&board_lock);
+    hill_scoreboard_update(&board, &state, esp_timer_get_time() / 1000, &index);
+    portEXIT_CRITICAL(&board_lock);
+#endif
+
+    send_frame(frame, hill_proto_encode(&state, frame, sizeof(frame)));
+}
+
+#ifdef HILL_LINK_AGGREGATOR
+// Beacon nosi vrijeme kad je prethodni beacon stvarno otišao, i zadnju komandu za početak
+static void send_beacon(void)
+{
+    uint8_t frame[HILL_SYNC_FRAME_SIZE];
+
+    portENTER_CRITICAL(&sync_lock);
+    hill_beacon_t beacon = {
+        .seq = beacon_seq++,
+        .start_id = start_id,
+        .previous_sent_us = beacon_sent_us,
+        .start_us = start_master_us,
+    };
+    portEXIT_CRITICAL(&sync_lock);
+    // Prošli početak se više ne oglašava, da ga brdo koje se upravo upalilo ne prijavi kao propušten
+    if (beacon.start_us < esp_timer_get_time() - HILL_START_MIN_DELAY_MS * 1000LL)
+    {
+        beacon.start_id = 0;
+    }
+
+    beacon_sent_us = 0; // Ako ovaj ne ode, sljedeći beacon ne nosi staro vrijeme
+    beacon_unconfirmed = send_frame(frame, hill_proto_encode_beacon(&beacon, frame, sizeof(frame)));
+}
+
+// Okvir sa drugog brda: ažuriraj tabelu i pretvori promjene u poruke
+static void handle_frame(const uint8_t *frame, int length, int64_t received_us)
+{
+    hill_state_t state;
+    int index;
+
+    if (hill_proto_type(frame, length) == HILL_MSG_SYNC)
+    {
+        return; // Vlastiti UDP broadcast, ili drugi agregator na terenu
+    }
+    if (!hill_proto_decode(frame, length, &state))
+    {
+        invalid++;
+        return;
+    }
+    if (strcmp(state.name, own_name) == 0)
+    {
+        return; // Vlastiti UDP broadcast
+    }
+
+    portENTER_CRITICAL(&board_lock);
+    uint32_t changes = hill_scoreboard_update(&board, &state, esp_timer_get_time() / 1000, &index);
+    portEXIT_CRITICAL(&board_lock);
+    if (changes & HILL_CHANGE_NEW)
+    {
+        ESP_LOGI(TAG, "Hill %s joined", state.name);
+    }
+    if (state.state == GAME_PLAYING && state.team != TEAM_NONE && (changes & (HILL_CHANGE_HOLDER | HILL_CHANGE_STATE)))
+    {
+        notifier_post_hill(NOTIFY_HILL_CAPTURED, hill_link_id(state.name), state.team, state.remaining_s);
+    }
+    else if (state.state == GAME_FINISHED && (changes & HILL_CHANGE_STATE))
+    {
+        notifier_post_hill(NOTIFY_HILL_GAME_OVER, hill_link_id(state.name), state.team, 0);
+    }
+}
+#else
+// Beacon sa agregatora: nova tačka za model sata, i možda komanda za početak
+static void handle_beacon(const uint8_t *frame, int length, int64_t received_us)
+{
+    hill_beacon_t beacon;
+
+    if (!hill_proto_decode_beacon(frame, length, &beacon))
+    {
+        invalid++;
+        return;
+    }
+    if (clear_sync_stats)
+    {
+        hill_sync_clear_stats(&sync);
+        clear_sync_stats = false;
+    }
+    if (hill_sync_beacon(&sync, &beacon, received_us))
+    {
+        portENTER_CRITICAL(&sync_lock);
+        clock_model = sync.model;
+        clock_synced = hill_sync_is_synced(&sync);
+        portEXIT_CRITICAL(&sync_lock);
+    }
+    if (!clock_synced)
+    {
+        return; // Komanda se pokuša ponovo sa sljedećim beacon-om
+    }
+
+    if (beacon.start_id != 0 && beacon.start_id != handled_start_id)
+    {
+        handled_start_id = beacon.start_id;
+        portENTER_CRITICAL(&sync_lock);
+        synced_start_master_us = beacon.start_us;
+        portEXIT_CRITICAL(&sync_lock);
+        if (!arm_start(hill_sync_to_local(&clock_model, beacon.start_us)))
+        {
+            missed_starts++;
+            ESP_LOGW(TAG, "Start %u arrived too late, skipped", beacon.start_id);
+        }
+    }
+    else if (pending_start_us != 0)
+    {
+        // Novi model pomjeri zakazani početak za nekoliko mikrosekundi
+        arm_start(hill_sync_to_local(&clock_model, synced_start_master_us));
+    }
+}
+#endif
+
+static void hill_link_task(void *arg)
+{
+    uint8_t frame[HILL_FRAME_MAX];
+    uint32_t sent_generation = 0;
+    int64_t last_send_us = 0;
+
+    if (transport->init() != 0)
+    {
+        ESP_LOGE(TAG, "Failed to start %s transport", transport->name);
+        vTaskDelete(NULL);
+    }
+
+    while (1)
+    {
+        int64_t received_us = 0;
+#ifdef HILL_LINK_AGGREGATOR
+        // Dok beacon čeka potvrdu ništa drugo se ne šalje, pa je javljeno vrijeme baš njegovo
+        int timeout_ms = beacon_unconfirmed ? HILL_CONFIRM_POLL_MS : HILL_POLL_MS;
+        int length = transport->receive(frame, sizeof(frame), timeout_ms, &received_us);
+        if (beacon_unconfirmed)
+        {
+            int64_t sent_us = transport->sent_us();
+            if (sent_us != 0 || esp_timer_get_time() - last_beacon_us >= HILL_CONFIRM_MS * 1000LL)
+            {
+                beacon_unconfirmed = false;
+                beacon_sent_us = sent_us;
+            }
+        }
+        if (length > 0)
+        {
+            handle_frame(frame, length, received_us);
+        }
+        portENTER_CRITICAL(&board_lock);
+        int offline = hill_scoreboard_expire(&board, esp_timer_get_time() / 1000, HILL_OFFLINE_MS);
+        portEXIT_CRITICAL(&board_lock);
+        if (offline > 0)
+        {
+            ESP_LOGW(TAG, "%d hills went offline", offline);
+        }
+#else
+        int length = transport->receive(frame, sizeof(frame), HILL_POLL_MS, &received_us);
+        if (length > 0 && hill_proto_type(frame, length) == HILL_MSG_SYNC)
+        {
+            handle_beacon(frame, length, received_us);
+        }
+#endif
+
+        // Vlastito stanje na svaku promjenu (generacija) i barem jednom u sekundi
+        game_snapshot_t game;
+        uint32_t generation = game_state_read(&game);
+        int64_t now = esp_timer_get_time();
+        bool may_send = true;
+#ifdef HILL_LINK_AGGREGATOR
+        may_send = !beacon_unconfirmed;
+#endif
+        if (may_send && (generation != sent_generation || now - last_send_us >= HILL_BEACON_MS * 1000LL))
+        {
+            send_state(&game);
+            sent_generation = generation;
+            last_send_us = now;
+        }
+
+#ifdef HILL_LINK_AGGREGATOR
+        if (may_send && now - last_beacon_us >= HILL_SYNC_INTERVAL_MS * 1000LL)
+        {
+            send_beacon();
+            last_beacon_us = now;
+        }
+#endif
+    }
+}
+#endif
+
+void hill_link_start(int game_seconds, hill_link_start_fn on_start, BaseType_t core, UBaseType_t priority)
+{
+#ifdef HILL_LINK_ENABLED
+    uint8_t mac[6];
+
+    // Sva brda imaju isti DEVICE_NAME, pa se razlikuju po kraju MAC adrese
+    game_time_seconds = game_seconds;
+    start_handler = on_start;
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(own_name, sizeof(own_name), HILL_NAME_FORMAT, DEVICE_NAME, (mac[4] << 8) | mac[5]);
+    hill_scoreboard_init(&board);
+#ifndef HILL_LINK_AGGREGATOR
+    hill_sync_init(&sync);
+#endif
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = start_timer_callback,
+        .name = "hill_start",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &start_timer));
+
+    ESP_LOGI(TAG, "Hill %s as %s over %s", own_name,
+#ifdef HILL_LINK_AGGREGATOR
+             "aggregator",
+#else
+             "member",
+#endif
+             transport->name);
+    xTaskCreatePinnedToCore(hill_link_task, "hill_link", 4096, NULL, priority, NULL, core);
+#endif
+}
+
+esp_err_t hill_link_start_all(uint32_t delay_ms)
+{
+#ifdef HILL_LINK_AGGREGATOR
+    if (delay_ms < HILL_START_MIN_DELAY_MS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Sat agregatora je referenca, pa je lokalno vrijeme početka isto kao u beacon-u
+    int64_t start_us = esp_timer_get_time() + delay_ms * 1000LL;
+    portENTER_CRITICAL(&sync_lock);
+    start_id = start_id == UINT16_MAX ? 1 : start_id + 1;
+    start_master_us = start_us;
+    synced_start_master_us = start_us;
+    portEXIT_CRITICAL(&sync_lock);
+
+    ESP_LOGI(TAG, "Starting all hills in %lu ms", (unsigned long)delay_ms);
+    return arm_start(start_us) ? ESP_OK : ESP_FAIL;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int64_t hill_link_tick_deadline(int64_t start_us, int seconds)
+{
+    int64_t offset_us = seconds * 1000000LL;
+#ifdef HILL_LINK_MEMBER
+    // Sekunde igre po satu agregatora, ako je ova igra zajednički početak
+    portENTER_CRITICAL(&sync_lock);
+    bool follow_master = clock_synced && start_us == synced_start_local_us;
+    hill_clock_model_t model = clock_model;
+    int64_t master_start_us = synced_start_master_us;
+    portEXIT_CRITICAL(&sync_lock);
+    if (follow_master)
+    {
+        return hill_sync_to_local(&model, master_start_us + offset_us);
+    }
+#endif
+    return start_us + offset_us;
+}
+
+uint16_t hill_link_id(const char *name)
+{
+    const char *suffix = strrchr(name, '-');
+    char *end;
+    if (suffix == NULL)
+    {
+        return 0;
+    }
+    unsigned long id = strtoul(suffix + 1, &end, 16);
+    return *end == '\0' && end - suffix == 5 ? (uint16_t)id : 0;
+}
+
+void hill_link_log_stats(void)
+{
+#ifdef HILL_LINK_ENABLED
+    ESP_LOGI(TAG, "%lu frames sent, %lu failed; %lu received, %lu duplicates, %lu invalid, %lu no room",
+             (unsigned long)sent, (unsigned long)send_failures, (unsigned long)board.frames,
+             (unsigned long)board.duplicates, (unsigned long)invalid, (unsigned long)board.full);
+    if (starts > 0)
+    {
+        ESP_LOGI(TAG, "%lu synchronized starts, last one dispatched %lld us late", (unsigned long)starts,
+                 start_late_us);
+    }
+#ifdef HILL_LINK_AGGREGATOR
+    for (int i = 0; i < HILL_MAX; i++)
+    {
+        // Kopija pod lock-om, da se ime ne ispiše dok ga hill_link zadatak mijenja
+        hill_entry_t copy;
+        portENTER_CRITICAL(&board_lock);
+        copy = board.hills[i];
+        portEXIT_CRITICAL(&board_lock);
+        const hill_entry_t *entry = &copy;
+        if (!entry->used)
+        {
+            continue;
+        }
+        char sync_error[16] = "not synced";
+        if (entry->state.sync_error_us != HILL_SYNC_ERROR_UNKNOWN)
+        {
+            snprintf(sync_error, sizeof(sync_error), "%u us", entry->state.sync_error_us);
+        }
+        ESP_LOGI(TAG, "  %-15s %-7s state %d, held by %s, %u s left, clock error %s", entry->state.name,
+                 entry->online ? "online" : "offline", entry->state.state, team_name(entry->state.team),
+                 entry->state.remaining_s, sync_error);
+    }
+#else
+    // Greška je razlika između prijema beacon-a i vremena koje je model predvidio
+    if (hill_sync_is_synced(&sync))
+    {
+        ESP_LOGI(TAG, "Clock synced: drift %+.2f ppm, error last %ld us, rms %ld us, max %lu us (%lu samples, %lu outliers, %lu resets)",
+                 hill_sync_drift_ppm(&sync), (long)sync.last_error_us, (long)hill_sync_rms_error_us(&sync),
+                 (unsigned long)sync.max_error_us, (unsigned long)sync.samples, (unsigned long)sync.outliers,
+                 (unsigned long)sync.resets);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Clock not synced: %lu beacons, %d samples", (unsigned long)sync.beacons, sync.count);
+    }
+    if (missed_starts > 0)
+    {
+        ESP_LOGW(TAG, "%lu synchronized starts missed", (unsigned long)missed_starts);
+    }
+    clear_sync_stats = true;
+#endif
+#endif
+}
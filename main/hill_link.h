@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ime brda: DEVICE_NAME i zadnja dva bajta MAC adrese, koja su i id brda u porukama
+#define HILL_NAME_FORMAT "%.10s-%04x"
+
+// Najmanje vremena do zajedničkog početka, da svako brdo primi bar dva beacon-a
+#define HILL_START_MIN_DELAY_MS 2000
+
+/**
+ * @brief Pokreni igru u lokalno vrijeme start_us (esp_timer)
+ *
+ * Zove se iz esp_timer zadatka u trenutku početka. Sat igre treba
+ * računati sekunde od start_us preko hill_link_tick_deadline().
+ */
+typedef void (*hill_link_start_fn)(int64_t start_us);
+
+/**
+ * @brief Pokreni razmjenu stanja sa ostalim brdima na terenu
+ *
+ * Uloga se bira pri build-u (-DHILL_LINK=member ili aggregator); bez
+ * toga ne radi ništa. Svako brdo šalje svoje stanje na svaku promjenu i
+ * barem jednom u sekundi. Agregator vodi tabelu svih brda, šalje jedan
+ * zajednički tok poruka kad neko zauzme drugo brdo ili kad se igra na
+ * njemu završi, i šalje beacon-e po kojima ostala brda usklađuju sat.
+ * Ostala brda ne šalju poruke sama. Wi-Fi mora već biti pokrenut.
+ *
+ * ESP-NOW šalje na kanalu na kojem je Wi-Fi stanica, pa sva brda moraju
+ * biti spojena na isti AP (isti kanal); brdo na drugom kanalu se ne čuje.
+ *
+ * @param on_start Zove se kad počne igra zakazana sa hill_link_start_all()
+ */
+void hill_link_start(int game_seconds, hill_link_start_fn on_start, BaseType_t core, UBaseType_t priority);
+
+/**
+ * @brief Zakaži početak igre na svim brdima za delay_ms (samo agregator)
+ *
+ * Brda koja nisu sinhronizovana ili ne stignu na vrijeme preskoče početak
+ * i to zapišu u log.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED ako ovo brdo nije agregator,
+ *         ESP_ERR_INVALID_ARG ako je delay_ms kraći od HILL_START_MIN_DELAY_MS
+ */
+esp_err_t hill_link_start_all(uint32_t delay_ms);
+
+/**
+ * @brief Lokalno vrijeme kad sat igre koja je počela u start_us treba pokazati seconds
+ *
+ * Za igru pokrenutu sa hill_link_start_all() sekunde se broje po satu
+ * agregatora, pa se ni drift kristala ne skuplja tokom igre; inače je
+ * to start_us + seconds.
+ */
+int64_t hill_link_tick_deadline(int64_t start_us, int seconds);
+
+/**
+ * @brief Id brda iz imena koje je napravio hill_link_start() (HILL_NAME_FORMAT)
+ *
+ * @return Zadnja dva bajta MAC adrese, ili 0 ako ime nema taj oblik
+ */
+uint16_t hill_link_id(const char *name);
+
+/**
+ * @brief Ispiši poslane i primljene okvire, grešku sata i tabelu brda (na agregatoru)
+ */
+void hill_link_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+#include <string.h>
+#include "hill_proto.h"
+
+static void put_u16(uint8_t *out, uint16_t value)
+{
+    out[0] = value & 0xff;
+    out[1] = value >> 8;
+}
+
+static uint16_t get_u16(const uint8_t *in)
+{
+    return in[0] | (in[1] << 8);
+}
+
+static void put_u64(uint8_t *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+static uint64_t get_u64(const uint8_t *in)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static void put_header(uint8_t *frame, uint8_t type)
+{
+    put_u16(frame, HILL_PROTO_MAGIC);
+    frame[2] = HILL_PROTO_VERSION;
+    frame[3] = type;
+}
+
+int hill_proto_type(const uint8_t *frame, size_t length)
+{
+    if (length < 4 || get_u16(frame) != HILL_PROTO_MAGIC || frame[2] != HILL_PROTO_VERSION)
+    {
+        return 0;
+    }
+    return frame[3];
+}
+
+size_t hill_proto_encode(const hill_state_t *state, uint8_t *frame, size_t size)
+{
+    size_t name_length = strnlen(state->name, HILL_NAME_MAX);
+    uint8_t team_count = state->team_count < HILL_TEAMS_MAX ? state->team_count : HILL_TEAMS_MAX;
+    size_t length = HILL_STATE_HEADER_SIZE + name_length + 2 * team_count;
+
+    if (length > size)
+    {
+        return 0;
+    }
+
+    put_header(frame, HILL_MSG_STATE);
+    put_u16(frame + 4, state->seq);
+    frame[6] = state->state;
+    frame[7] = (uint8_t)state->team;
+    put_u16(frame + 8, state->remaining_s);
+    frame[10] = team_count;
+    frame[11] = (uint8_t)name_length;
+    put_u16(frame + 12, state->sync_error_us);
+    memcpy(frame + HILL_STATE_HEADER_SIZE, state->name, name_length);
+    for (int i = 0; i < team_count; i++)
+    {
+        put_u16(frame + HILL_STATE_HEADER_SIZE + name_length + 2 * i, state->hold_seconds[i]);
+    }
+    return length;
+}
+
+bool hill_proto_decode(const uint8_t *frame, size_t length, hill_state_t *state)
+{
+    if (length < HILL_STATE_HEADER_SIZE || hill_proto_type(frame, length) != HILL_MSG_STATE)
+    {
+        return false;
+    }
+
+    uint8_t team_count = frame[10];
+    uint8_t name_length = frame[11];
+    if (team_count > HILL_TEAMS_MAX || name_length == 0 || name_length > HILL_NAME_MAX ||
+        length != HILL_STATE_HEADER_SIZE + name_length + 2u * team_count)
+    {
+        return false;
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->seq = get_u16(frame + 4);
+    state->state = frame[6];
+    state->team = (int8_t)frame[7];
+    state->remaining_s = get_u16(frame + 8);
+    state->team_count = team_count;
+    state->sync_error_us = get_u16(frame + 12);
+    memcpy(state->name, frame + HILL_STATE_HEADER_SIZE, name_length);
+    for (int i = 0; i < team_count; i++)
+    {
+        state->hold_seconds[i] = get_u16(frame + HILL_STATE_HEADER_SIZE + name_length + 2 * i);
+    }
+    return true;
+}
+
+size_t hill_proto_encode_beacon(const hill_beacon_t *beacon, uint8_t *frame, size_t size)
+{
+    if (size < HILL_SYNC_FRAME_SIZE)
+    {
+        return 0;
+    }
+
+    put_header(frame, HILL_MSG_SYNC);
+    put_u16(frame + 4, beacon->seq);
+    put_u16(frame + 6, beacon->start_id);
+    put_u64(frame + 8, (uint64_t)beacon->previous_sent_us);
+    put_u64(frame + 16, (uint64_t)beacon->start_us);
+    return HILL_SYNC_FRAME_SIZE;
+}
+
+bool hill_proto_decode_beacon(const uint8_t *frame, size_t length, hill_beacon_t *beacon)
+{
+    if (length != HILL_SYNC_FRAME_SIZE || hill_proto_type(frame, length) != HILL_MSG_SYNC)
+    {
+        return false;
+    }
+
+    beacon->seq = get_u16(frame + 4);
+    beacon->start_id = get_u16(frame + 6);
+    beacon->previous_sent_us = (int64_t)get_u64(frame + 8);
+    beacon->start_us = (int64_t)get_u64(frame + 16);
+    return true;
+}
+
+void hill_scoreboard_init(hill_scoreboard_t *board)
+{
+    memset(board, 0, sizeof(*board));
+}
+
+static int find_hill(hill_scoreboard_t *board, const char *name)
+{
+    int free_slot = -1;
+    for (int i = 0; i < HILL_MAX; i++)
+    {
+        if (!board->hills[i].used)
+        {
+            if (free_slot < 0)
+            {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (strcmp(board->hills[i].state.name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return free_slot;
+}
+
+uint32_t hill_scoreboard_update(hill_scoreboard_t *board, const hill_state_t *state, int64_t now_ms, int *index)
+{
+    uint32_t changes = 0;
+    int i = find_hill(board, state->name);
+
+    *index = i;
+    if (i < 0)
+    {
+        board->full++;
+        return 0;
+    }
+
+    hill_entry_t *entry = &board->hills[i];
+    if (!entry->used || !entry->online)
+    {
+        // Nakon isteka ili restarta brda redni brojevi kreću ispočetka
+        changes |= HILL_CHANGE_NEW;
+    }
+    else
+    {
+        // Stariji redni broj (sa prelazom preko 65535) je ponovljen ili zakasnio okvir
+        int16_t delta = (int16_t)(state->seq - entry->state.seq);
+        if (delta <= 0)
+        {
+            board->duplicates++;
+            return 0;
+        }
+        if (state->team != entry->state.team)
+        {
+            changes |= HILL_CHANGE_HOLDER;
+        }
+        if (state->state != entry->state.state)
+        {
+            changes |= HILL_CHANGE_STATE;
+        }
+    }
+
+    entry->used = true;
+    entry->online = true;
+    entry->last_seen_ms = now_ms;
+    entry->state = *state;
+    board->frames++;
+    return changes;
+}
+
+int hill_scoreboard_expire(hill_scoreboard_t *board, int64_t now_ms, int64_t timeout_ms)
+{
+    int expired = 0;
+    for (int i = 0; i < HILL_MAX; i++)
+    {
+        hill_entry_t *entry = &board->hills[i];
+        if (entry->used && entry->online && now_ms - entry->last_seen_ms > timeout_ms)
+        {
+            entry->online = false;
+            expired++;
+        }
+    }
+    return expired;
+}
+
+int hill_scoreboard_hills_held(const hill_scoreboard_t *board, int8_t team)
+{
+    int held = 0;
+    for (int i = 0; i < HILL_MAX; i++)
+    {
+        const hill_entry_t *entry = &board->hills[i];
+        if (entry->used && entry->online && entry->state.team == team)
+        {
+            held++;
+        }
+    }
+    return held;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Protokol između brda na istom terenu. Ne zavisi od ESP-IDF-a, pa se
+ * kodiranje i tabela brda mogu testirati i na Linux-u (tools/hill_sim.c).
+ *
+ * Svi okviri počinju sa HILL_PROTO_MAGIC (0..1), HILL_PROTO_VERSION (2)
+ * i vrstom poruke (3). Svi brojevi su little-endian.
+ *
+ * Okvir stanja (HILL_MSG_STATE), šalje ga svako brdo:
+ *   4..5  redni broj okvira
+ *   6     stanje igre (GameState)
+ *   7     tim koji drži brdo (int8, -1 = nijedan)
+ *   8..9  preostalo vrijeme igre u sekundama
+ *   10    broj timova n
+ *   11    dužina imena l
+ *   12..13 greška sinhronizacije sata u mikrosekundama (HILL_SYNC_ERROR_UNKNOWN = nije sinhronizovan)
+ *   14..  ime brda (l bajtova, bez nule), pa n x uint16 sekundi držanja po timu
+ *
+ * Beacon sata (HILL_MSG_SYNC), šalje ga samo agregator:
+ *   4..5  redni broj beacon-a
+ *   6..7  broj komande za zajednički početak (0 = nema je)
+ *   8..15 vrijeme kad je prethodni beacon stvarno poslan (int64 us, sat agregatora, 0 = nepoznato)
+ *   16..23 vrijeme zajedničkog početka (int64 us, sat agregatora)
+ */
+#define HILL_PROTO_MAGIC 0x484b // "KH"
+#define HILL_PROTO_VERSION 2
+#define HILL_MSG_STATE 1
+#define HILL_MSG_SYNC 2
+
+#define HILL_NAME_MAX 15
+#define HILL_TEAMS_MAX 8
+#define HILL_STATE_HEADER_SIZE 14
+#define HILL_SYNC_FRAME_SIZE 24
+#define HILL_FRAME_MAX (HILL_STATE_HEADER_SIZE + HILL_NAME_MAX + 2 * HILL_TEAMS_MAX)
+
+#define HILL_SYNC_ERROR_UNKNOWN 0xffff
+
+// Najviše brda u tabeli agregatora
+#define HILL_MAX 8
+
+typedef struct
+{
+    char name[HILL_NAME_MAX + 1];
+    uint16_t seq;
+    uint8_t state;
+    int8_t team;
+    uint16_t remaining_s;
+    uint8_t team_count;
+    uint16_t sync_error_us; // Ili HILL_SYNC_ERROR_UNKNOWN
+    uint16_t hold_seconds[HILL_TEAMS_MAX];
+} hill_state_t;
+
+typedef struct
+{
+    uint16_t seq;
+    uint16_t start_id;
+    int64_t previous_sent_us; // Kad je beacon seq - 1 napustio agregator
+    int64_t start_us;
+} hill_beacon_t;
+
+/**
+ * @return Vrsta poruke (HILL_MSG_*), ili 0 ako okvir nije ovog protokola i verzije
+ */
+int hill_proto_type(const uint8_t *frame, size_t length);
+
+/**
+ * @return Dužina okvira, ili 0 ako buffer nije dovoljan
+ */
+size_t hill_proto_encode(const hill_state_t *state, uint8_t *frame, size_t size);
+
+/**
+ * @return false ako okvir nije ispravan okvir stanja ove verzije
+ */
+bool hill_proto_decode(const uint8_t *frame, size_t length, hill_state_t *state);
+
+/**
+ * @return Dužina okvira (HILL_SYNC_FRAME_SIZE), ili 0 ako buffer nije dovoljan
+ */
+size_t hill_proto_encode_beacon(const hill_beacon_t *beacon, uint8_t *frame, size_t size);
+
+/**
+ * @return false ako okvir nije ispravan beacon
+ */
+bool hill_proto_decode_beacon(const uint8_t *frame, size_t length, hill_beacon_t *beacon);
+
+// Šta se promijenilo u tabeli nakon okvira
+#define HILL_CHANGE_NEW (1 << 0)    // Brdo se prvi put javilo (ili ponovo nakon isteka)
+#define HILL_CHANGE_HOLDER (1 << 1) // Drugi tim drži brdo
+#define HILL_CHANGE_STATE (1 << 2)  // Igra na brdu je počela ili završila
+
+typedef struct
+{
+    bool used;
+    bool online;
+    int64_t last_seen_ms;
+    hill_state_t state;
+} hill_entry_t;
+
+typedef struct
+{
+    hill_entry_t hills[HILL_MAX];
+    uint32_t frames;     // Primljeni ispravni okviri
+    uint32_t duplicates; // Okviri sa starim rednim brojem (ponovljeni ili izmiješani)
+    uint32_t full;       // Okviri od brda koje nije stalo u tabelu
+} hill_scoreboard_t;
+
+void hill_scoreboard_init(hill_scoreboard_t *board);
+
+/**
+ * @brief Upiši okvir u tabelu
+ *
+ * @param index Indeks brda u tabeli (ili -1 ako je okvir odbačen)
+ * @return HILL_CHANGE_* bitovi
+ */
+uint32_t hill_scoreboard_update(hill_scoreboard_t *board, const hill_state_t *state, int64_t now_ms, int *index);
+
+/**
+ * @brief Označi brda od kojih nije stigao okvir duže od timeout_ms
+ *
+ * @return Broj brda koja su upravo prešla u offline
+ */
+int hill_scoreboard_expire(hill_scoreboard_t *board, int64_t now_ms, int64_t timeout_ms);
+
+/**
+ * @return Broj brda (online) koja trenutno drži tim
+ */
+int hill_scoreboard_hills_held(const hill_scoreboard_t *board, int8_t team);
+
+#ifdef __cplusplus
+}
+#endif
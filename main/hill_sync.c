@@ -0,0 +1,172 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hill_sync.h"
+
+void hill_sync_init(hill_sync_t *sync)
+{
+    memset(sync, 0, sizeof(*sync));
+}
+
+// Zaboravi tačke, npr. nakon restarta agregatora; statistika ostaje
+static void reset_model(hill_sync_t *sync)
+{
+    sync->count = 0;
+    sync->next = 0;
+    sync->model.skew = 0;
+    sync->outliers_in_row = 0;
+    sync->resets++;
+}
+
+// Najmanji kvadrati kroz sve tačke, relativno prema najnovijoj da brojevi ostanu mali
+static void fit(hill_sync_t *sync)
+{
+    int newest = (sync->next + HILL_SYNC_SAMPLES - 1) % HILL_SYNC_SAMPLES;
+    int64_t master0 = sync->master_us[newest];
+    int64_t local0 = sync->local_us[newest];
+    double sum_x = 0;
+    double sum_y = 0;
+
+    // x = vrijeme agregatora, y = pomak lokalnog sata u tom trenutku
+    for (int i = 0; i < sync->count; i++)
+    {
+        double x = (double)(sync->master_us[i] - master0);
+        sum_x += x;
+        sum_y += (double)(sync->local_us[i] - local0) - x;
+    }
+    double mean_x = sum_x / sync->count;
+    double mean_y = sum_y / sync->count;
+
+    double covariance = 0;
+    double variance = 0;
+    for (int i = 0; i < sync->count; i++)
+    {
+        double x = (double)(sync->master_us[i] - master0);
+        double y = (double)(sync->local_us[i] - local0) - x;
+        covariance += (x - mean_x) * (y - mean_y);
+        variance += (x - mean_x) * (x - mean_x);
+    }
+    sync->model.skew = variance > 0 ? covariance / variance : 0;
+
+    // Prava prolazi kroz težište tačaka
+    sync->model.ref_master_us = master0 + (int64_t)llround(mean_x);
+    sync->model.ref_local_us = local0 + (int64_t)llround(mean_x + mean_y);
+}
+
+static void add_sample(hill_sync_t *sync, int64_t master_us, int64_t local_us)
+{
+    if (hill_sync_is_synced(sync))
+    {
+        int64_t error_us = local_us - hill_sync_to_local(&sync->model, master_us);
+        int64_t magnitude = llabs(error_us);
+        if (magnitude > HILL_SYNC_OUTLIER_US)
+        {
+            sync->outliers++;
+            if (++sync->outliers_in_row < HILL_SYNC_OUTLIERS_TO_RESET)
+            {
+                return;
+            }
+            reset_model(sync);
+        }
+        else
+        {
+            sync->outliers_in_row = 0;
+            sync->last_error_us = (int32_t)error_us;
+            if (magnitude > sync->max_error_us)
+            {
+                sync->max_error_us = magnitude;
+            }
+            sync->error_square_sum += (double)error_us * error_us;
+            sync->error_count++;
+        }
+    }
+
+    sync->master_us[sync->next] = master_us;
+    sync->local_us[sync->next] = local_us;
+    sync->next = (sync->next + 1) % HILL_SYNC_SAMPLES;
+    if (sync->count < HILL_SYNC_SAMPLES)
+    {
+        sync->count++;
+    }
+    sync->samples++;
+    fit(sync);
+}
+
+bool hill_sync_beacon(hill_sync_t *sync, const hill_beacon_t *beacon, int64_t received_us)
+{
+    bool updated = false;
+
+    sync->beacons++;
+    // Vrijeme slanja prethodnog beacon-a upari se sa njegovim prijemom, ako ga nismo propustili
+    if (sync->have_previous && beacon->previous_sent_us != 0 && (uint16_t)(sync->previous_seq + 1) == beacon->seq)
+    {
+        if (sync->count > 0)
+        {
+            int newest = (sync->next + HILL_SYNC_SAMPLES - 1) % HILL_SYNC_SAMPLES;
+            if (beacon->previous_sent_us <= sync->master_us[newest])
+            {
+                // Sat agregatora je krenuo ispočetka
+                reset_model(sync);
+            }
+        }
+        add_sample(sync, beacon->previous_sent_us, sync->previous_received_us);
+        updated = true;
+    }
+
+    sync->have_previous = true;
+    sync->previous_seq = beacon->seq;
+    sync->previous_received_us = received_us;
+    return updated;
+}
+
+bool hill_sync_is_synced(const hill_sync_t *sync)
+{
+    return sync->count >= HILL_SYNC_MIN_SAMPLES;
+}
+
+int64_t hill_sync_to_local(const hill_clock_model_t *model, int64_t master_us)
+{
+    int64_t elapsed_us = master_us - model->ref_master_us;
+    return model->ref_local_us + elapsed_us + (int64_t)llround(elapsed_us * model->skew);
+}
+
+int64_t hill_sync_to_master(const hill_clock_model_t *model, int64_t local_us)
+{
+    int64_t elapsed_us = local_us - model->ref_local_us;
+    return model->ref_master_us + (int64_t)llround(elapsed_us / (1 + model->skew));
+}
+
+double hill_sync_drift_ppm(const hill_sync_t *sync)
+{
+    return sync->model.skew * 1e6;
+}
+
+int32_t hill_sync_rms_error_us(const hill_sync_t *sync)
+{
+    if (sync->error_count == 0)
+    {
+        return -1;
+    }
+    return (int32_t)lround(sqrt(sync->error_square_sum / sync->error_count));
+}
+
+uint16_t hill_sync_reported_error_us(const hill_sync_t *sync)
+{
+    int32_t rms_us = hill_sync_rms_error_us(sync);
+    if (!hill_sync_is_synced(sync))
+    {
+        return HILL_SYNC_ERROR_UNKNOWN;
+    }
+    if (rms_us < 0)
+    {
+        rms_us = sync->last_error_us < 0 ? -sync->last_error_us : sync->last_error_us;
+    }
+    return rms_us < HILL_SYNC_ERROR_UNKNOWN ? rms_us : HILL_SYNC_ERROR_UNKNOWN - 1;
+}
+
+void hill_sync_clear_stats(hill_sync_t *sync)
+{
+    sync->max_error_us = 0;
+    sync->error_square_sum = 0;
+    sync->error_count = 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hill_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Procjena sata agregatora iz beacon-a. Ne zavisi od ESP-IDF-a.
+ *
+ * Agregator u svakom beacon-u javi kad je prethodni beacon stvarno
+ * napustio radio, a brdo je zapamtilo kad ga je primilo. Svaki takav par
+ * je jedna tačka; prava kroz zadnjih HILL_SYNC_SAMPLES tačaka (najmanji
+ * kvadrati) daje pomak i brzinu (drift) lokalnog sata u odnosu na sat
+ * agregatora. Kašnjenje radija je isto za sva brda, pa se poništi kad
+ * se brda porede međusobno.
+ *
+ * Greška je razlika između vremena prijema i onoga što je model
+ * predvidio prije nego što je tačka dodana - to je greška sata koju bi
+ * brdo imalo da je upravo tad pokrenulo igru.
+ */
+#define HILL_SYNC_SAMPLES 16
+#define HILL_SYNC_MIN_SAMPLES 4       // Prije ovoga brdo nije sinhronizovano
+#define HILL_SYNC_OUTLIER_US 2000     // Tačka dalje od modela se preskače...
+#define HILL_SYNC_OUTLIERS_TO_RESET 3 // ...osim ako ih je ovoliko zaredom (agregator restartovan)
+
+// Model: local = ref_local + (master - ref_master) * (1 + skew); mali, da se može kopirati drugom zadatku
+typedef struct
+{
+    int64_t ref_master_us;
+    int64_t ref_local_us;
+    double skew;
+} hill_clock_model_t;
+
+typedef struct
+{
+    // Tačke (sat agregatora, lokalni sat), kružno
+    int64_t master_us[HILL_SYNC_SAMPLES];
+    int64_t local_us[HILL_SYNC_SAMPLES];
+    int count;
+    int next;
+
+    hill_clock_model_t model;
+
+    // Prijem zadnjeg beacon-a, čeka vrijeme slanja iz sljedećeg
+    bool have_previous;
+    uint16_t previous_seq;
+    int64_t previous_received_us;
+    int outliers_in_row;
+
+    // Statistika
+    uint32_t beacons;
+    uint32_t samples;
+    uint32_t outliers;
+    uint32_t resets;
+    int32_t last_error_us;
+    uint32_t max_error_us;     // Od zadnjeg hill_sync_clear_stats()
+    double error_square_sum;   // Za RMS, od zadnjeg hill_sync_clear_stats()
+    uint32_t error_count;
+} hill_sync_t;
+
+void hill_sync_init(hill_sync_t *sync);
+
+/**
+ * @brief Obradi beacon primljen u lokalno vrijeme received_us
+ *
+ * @return true ako je model promijenjen
+ */
+bool hill_sync_beacon(hill_sync_t *sync, const hill_beacon_t *beacon, int64_t received_us);
+
+bool hill_sync_is_synced(const hill_sync_t *sync);
+
+/**
+ * @return Lokalno vrijeme koje odgovara vremenu agregatora (model važi tek kad je sinhronizovan)
+ */
+int64_t hill_sync_to_local(const hill_clock_model_t *model, int64_t master_us);
+
+/**
+ * @return Vrijeme agregatora koje odgovara lokalnom vremenu
+ */
+int64_t hill_sync_to_master(const hill_clock_model_t *model, int64_t local_us);
+
+/**
+ * @return Drift lokalnog sata u ppm (pozitivno = lokalni sat ide brže)
+ */
+double hill_sync_drift_ppm(const hill_sync_t *sync);
+
+/**
+ * @return RMS greške od zadnjeg hill_sync_clear_stats(), ili -1 bez mjerenja
+ */
+int32_t hill_sync_rms_error_us(const hill_sync_t *sync);
+
+/**
+ * @return Greška za okvir stanja: RMS (ili zadnja greška odmah nakon brisanja statistike),
+ *         ili HILL_SYNC_ERROR_UNKNOWN
+ */
+uint16_t hill_sync_reported_error_us(const hill_sync_t *sync);
+
+void hill_sync_clear_stats(hill_sync_t *sync);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Prenos okvira između brda (ESP-NOW na uređaju, UDP na uređaju i na Linux-u)
+ *
+ * Okviri idu svima na lokalnoj mreži (broadcast), a agregator uzima
+ * okvire svih brda. Sve funkcije se pozivaju iz jednog zadatka/niti.
+ * Vraćaju 0 (ili dužinu) za uspjeh, a negativan broj za grešku, da
+ * ne zavise od esp_err_t.
+ */
+typedef struct
+{
+    const char *name;
+
+    // Pripremi prenos; mreža (Wi-Fi) mora već biti pokrenuta
+    int (*init)(void);
+
+    // Pošalji okvir svim brdima
+    int (*send)(const uint8_t *frame, size_t length);
+
+    // Kad je zadnji poslani okvir stvarno otišao (hill_now_us()), ili 0 dok se ne zna;
+    // vrijeme ranijeg okvira se nikad ne javlja kao vrijeme zadnjeg
+    int64_t (*sent_us)(void);
+
+    // Čekaj okvir najviše timeout_ms; vraća dužinu, 0 za timeout, ili < 0 za grešku.
+    // received_us je hill_now_us() što bliže trenutku prijema.
+    int (*receive)(uint8_t *frame, size_t size, int timeout_ms, int64_t *received_us);
+} hill_transport_t;
+
+// Sat za vremena slanja i prijema: esp_timer na uređaju, monotoni sat na Linux-u
+static inline int64_t hill_now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+#endif
+}
+
+extern const hill_transport_t hill_udp_transport;
+#ifdef ESP_PLATFORM
+extern const hill_transport_t hill_espnow_transport;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "hill_transport.h"
+
+// Isti kod radi preko lwIP-a na uređaju i preko POSIX socketa na Linux-u
+#ifndef HILL_UDP_PORT
+#define HILL_UDP_PORT 4210
+#endif
+
+static int sock = -1;
+static int64_t last_sent_us = 0;
+
+static int udp_init(void)
+{
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(HILL_UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int enable = 1;
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+    // Više procesa na istom računaru (simulirana brda) dijeli port
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+#endif
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        close(sock);
+        sock = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static int udp_send(const uint8_t *frame, size_t length)
+{
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(HILL_UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_BROADCAST),
+    };
+    // Bez vremena sa mrežne kartice; sendto se vraća tek kad je okvir predan drajveru
+    last_sent_us = 0;
+    if (sendto(sock, frame, length, 0, (struct sockaddr *)&address, sizeof(address)) != (ssize_t)length)
+    {
+        return -1;
+    }
+    last_sent_us = hill_now_us();
+    return 0;
+}
+
+static int64_t udp_sent_us(void)
+{
+    return last_sent_us;
+}
+
+static int udp_receive(uint8_t *frame, size_t size, int timeout_ms, int64_t *received_us)
+{
+    fd_set readable;
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+
+    FD_ZERO(&readable);
+    FD_SET(sock, &readable);
+    int ready = select(sock + 1, &readable, NULL, NULL, &timeout);
+    if (ready <= 0)
+    {
+        return ready;
+    }
+    *received_us = hill_now_us();
+    return (int)recv(sock, frame, size, 0);
+}
+
+const hill_transport_t hill_udp_transport = {
+    .name = "udp",
+    .init = udp_init,
+    .send = udp_send,
+    .sent_us = udp_sent_us,
+    .receive = udp_receive,
+};
@@ -0,0 +1,197 @@
+#include <string.h>
+#include "json_writer.h"
+
+void json_writer_init(json_writer_t *writer, char *buffer, size_t size)
+{
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->length = 0;
+    writer->has_items = 0;
+    writer->depth = 0;
+    writer->after_key = false;
+    writer->overflow = size == 0;
+}
+
+// Uvijek ostavi mjesta za završnu nulu
+static void put(json_writer_t *writer, const char *data, size_t length)
+{
+    if (writer->overflow || writer->length + length >= writer->size)
+    {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+}
+
+static void put_char(json_writer_t *writer, char c)
+{
+    if (writer->overflow || writer->length + 1 >= writer->size)
+    {
+        writer->overflow = true;
+        return;
+    }
+    writer->buffer[writer->length++] = c;
+}
+
+// Zarez prije svake vrijednosti osim prve u kontejneru (i osim vrijednosti ključa)
+static void begin_value(json_writer_t *writer)
+{
+    if (writer->after_key)
+    {
+        writer->after_key = false;
+        return;
+    }
+    uint16_t bit = 1u << writer->depth;
+    if (writer->has_items & bit)
+    {
+        put_char(writer, ',');
+    }
+    writer->has_items |= bit;
+}
+
+static void open_container(json_writer_t *writer, char c)
+{
+    begin_value(writer);
+    put_char(writer, c);
+    if (writer->depth + 1 >= JSON_WRITER_MAX_DEPTH)
+    {
+        writer->overflow = true;
+        return;
+    }
+    writer->depth++;
+    writer->has_items &= ~(1u << writer->depth);
+}
+
+static void close_container(json_writer_t *writer, char c)
+{
+    if (writer->depth == 0)
+    {
+        writer->overflow = true;
+        return;
+    }
+    writer->depth--;
+    put_char(writer, c);
+}
+
+void json_object_begin(json_writer_t *writer)
+{
+    open_container(writer, '{');
+}
+
+void json_object_end(json_writer_t *writer)
+{
+    close_container(writer, '}');
+}
+
+void json_array_begin(json_writer_t *writer)
+{
+    open_container(writer, '[');
+}
+
+void json_array_end(json_writer_t *writer)
+{
+    close_container(writer, ']');
+}
+
+static void put_escaped(json_writer_t *writer, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(writer, '"');
+    // Dijelovi bez posebnih znakova se kopiraju odjednom
+    const char *run = value;
+    for (const char *p = value; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        put(writer, run, p - run);
+        run = p + 1;
+        if (c == '"' || c == '\\')
+        {
+            char escaped[2] = {'\\', (char)c};
+            put(writer, escaped, sizeof(escaped));
+        }
+        else if (c == '\n')
+        {
+            put(writer, "\\n", 2);
+        }
+        else
+        {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+            put(writer, escaped, sizeof(escaped));
+        }
+    }
+    put(writer, run, strlen(run));
+    put_char(writer, '"');
+}
+
+void json_key(json_writer_t *writer, const char *key)
+{
+    begin_value(writer);
+    put_escaped(writer, key);
+    put_char(writer, ':');
+    writer->after_key = true;
+}
+
+void json_string(json_writer_t *writer, const char *value)
+{
+    begin_value(writer);
+    put_escaped(writer, value);
+}
+
+void json_int(json_writer_t *writer, int64_t value)
+{
+    char digits[20];
+    int count = 0;
+    // Negativni brojevi preko uint64_t, da i INT64_MIN radi
+    uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+
+    begin_value(writer);
+    if (value < 0)
+    {
+        put_char(writer, '-');
+    }
+    do
+    {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    while (count > 0)
+    {
+        put_char(writer, digits[--count]);
+    }
+}
+
+void json_bool(json_writer_t *writer, bool value)
+{
+    begin_value(writer);
+    if (value)
+    {
+        put(writer, "true", 4);
+    }
+    else
+    {
+        put(writer, "false", 5);
+    }
+}
+
+void json_null(json_writer_t *writer)
+{
+    begin_value(writer);
+    put(writer, "null", 4);
+}
+
+int json_writer_finish(json_writer_t *writer)
+{
+    if (writer->overflow || writer->depth != 0)
+    {
+        return -1;
+    }
+    writer->buffer[writer->length] = '\0';
+    return (int)writer->length;
+}
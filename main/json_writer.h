@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Najveća dubina ugniježđenih objekata i nizova
+#define JSON_WRITER_MAX_DEPTH 16
+
+/**
+ * @brief JSON pisac u bafer pozivaoca, bez heap-a i bez printf-a
+ *
+ * Zarezi i dvotačke se dodaju sami. Ako bafer nije dovoljan, pisac
+ * zapamti grešku, a json_writer_finish() vrati -1.
+ */
+typedef struct
+{
+    char *buffer;
+    size_t size;
+    size_t length;
+    uint16_t has_items; // Bit po dubini: kontejner već ima barem jednu vrijednost
+    uint8_t depth;
+    bool after_key;
+    bool overflow;
+} json_writer_t;
+
+void json_writer_init(json_writer_t *writer, char *buffer, size_t size);
+
+void json_object_begin(json_writer_t *writer);
+void json_object_end(json_writer_t *writer);
+void json_array_begin(json_writer_t *writer);
+void json_array_end(json_writer_t *writer);
+
+/**
+ * @brief Ključ u objektu; sljedeći poziv upisuje njegovu vrijednost
+ */
+void json_key(json_writer_t *writer, const char *key);
+
+/**
+ * @brief String sa escape-om navodnika, kose crte i kontrolnih znakova
+ */
+void json_string(json_writer_t *writer, const char *value);
+void json_int(json_writer_t *writer, int64_t value);
+void json_bool(json_writer_t *writer, bool value);
+void json_null(json_writer_t *writer);
+
+/**
+ * @brief Završi string nulom
+ *
+ * @return Dužina bez nule, ili -1 ako bafer nije bio dovoljan ili
+ *         kontejneri nisu zatvoreni
+ */
+int json_writer_finish(json_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "latency.h"
+
+static const char *TAG = "latency";
+
+// Log-linearni histogram: 8 pod-korpi po stepenu dvojke, greška percentila do 12.5%
+#define LATENCY_SUB_BUCKETS 8
+#define LATENCY_BUCKETS ((32 - 2) * LATENCY_SUB_BUCKETS)
+
+typedef struct
+{
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} latency_histogram_t;
+
+static const char *stage_names[LATENCY_STAGE_COUNT] = {
+    [LATENCY_COMMIT] = "edge->commit",
+    [LATENCY_LED] = "edge->led",
+    [LATENCY_DISPLAY] = "edge->oled",
+    [LATENCY_HTTP_NEW] = "http new",
+    [LATENCY_HTTP_REUSED] = "http reused",
+    [LATENCY_MQTT_PUBLISH] = "mqtt publish",
+};
+
+static latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+static portMUX_TYPE histogram_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int bucket_of(uint32_t value)
+{
+    if (value < LATENCY_SUB_BUCKETS)
+    {
+        return value;
+    }
+    int msb = 31 - __builtin_clz(value);
+    return (msb - 2) * LATENCY_SUB_BUCKETS + ((value >> (msb - 3)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+// Najveća vrijednost koja upada u korpu
+static uint32_t bucket_upper_bound(int bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int msb = bucket / LATENCY_SUB_BUCKETS + 2;
+    uint32_t sub = bucket % LATENCY_SUB_BUCKETS;
+    uint32_t lower = (LATENCY_SUB_BUCKETS + sub) << (msb - 3);
+    return lower + (1u << (msb - 3)) - 1;
+}
+
+void latency_record(latency_stage_t stage, uint32_t latency_us)
+{
+    latency_histogram_t *histogram = &histograms[stage];
+
+    portENTER_CRITICAL(&histogram_lock);
+    histogram->buckets[bucket_of(latency_us)]++;
+    histogram->count++;
+    if (latency_us > histogram->max_us)
+    {
+        histogram->max_us = latency_us;
+    }
+    portEXIT_CRITICAL(&histogram_lock);
+}
+
+void latency_record_frame(latency_stage_t stage, int64_t edge_us, int64_t *last_edge_us)
+{
+    if (edge_us == 0 || edge_us == *last_edge_us)
+    {
+        return;
+    }
+    *last_edge_us = edge_us;
+    latency_record(stage, (uint32_t)(esp_timer_get_time() - edge_us));
+}
+
+void latency_reset(void)
+{
+    portENTER_CRITICAL(&histogram_lock);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&histogram_lock);
+}
+
+static uint32_t percentile(const latency_histogram_t *histogram, uint32_t percent)
+{
+    // Rang mjerenja koje je na zadanom percentilu (zaokruženo naviše)
+    uint32_t rank = (histogram->count * percent + 99) / 100;
+    uint32_t seen = 0;
+
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t bound = bucket_upper_bound(i);
+            return bound < histogram->max_us ? bound : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
+
+void latency_print(void)
+{
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++)
+    {
+        // Kopija da ispis ne drži spinlock
+        static latency_histogram_t copy;
+        portENTER_CRITICAL(&histogram_lock);
+        copy = histograms[stage];
+        portEXIT_CRITICAL(&histogram_lock);
+
+        if (copy.count == 0)
+        {
+            ESP_LOGI(TAG, "%-13s no samples", stage_names[stage]);
+            continue;
+        }
+        ESP_LOGI(TAG, "%-13s n=%lu p50=%lu us p99=%lu us max=%lu us", stage_names[stage],
+                 (unsigned long)copy.count, (unsigned long)percentile(&copy, 50),
+                 (unsigned long)percentile(&copy, 99), (unsigned long)copy.max_us);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Faze od ivice tipke do prikaza, mjerene od vremena ivice iz ISR-a,
+// i trajanje slanja obavještenja
+typedef enum
+{
+    LATENCY_COMMIT,       // Novo stanje igre objavljeno
+    LATENCY_LED,          // Sljedeći LED frejm poslan
+    LATENCY_DISPLAY,      // Sljedeći OLED frejm poslan
+    LATENCY_HTTP_NEW,     // HTTP zahtjev koji je morao otvoriti konekciju
+    LATENCY_HTTP_REUSED,  // HTTP zahtjev preko otvorene konekcije
+    LATENCY_MQTT_PUBLISH, // Predaja poruke MQTT klijentu
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+/**
+ * @brief Upiši jedno mjerenje u histogram faze
+ */
+void latency_record(latency_stage_t stage, uint32_t latency_us);
+
+/**
+ * @brief Upiši kašnjenje frejma ako je frejm prvi koji prikazuje ivicu edge_us
+ *
+ * @param last_edge_us Zadnja ivica koju je ovaj zadatak već izmjerio
+ */
+void latency_record_frame(latency_stage_t stage, int64_t edge_us, int64_t *last_edge_us);
+
+/**
+ * @brief Obriši sve histograme (npr. između mečeva)
+ */
+void latency_reset(void);
+
+/**
+ * @brief Ispiši broj mjerenja, p50, p99 i maksimum za svaku fazu
+ */
+void latency_print(void);
+
+#ifdef __cplusplus
+}
+#endif
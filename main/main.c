@@ -14,11 +14,24 @@
 #include "esp_wifi.h"
 #include "esp_http_client.h"
 #include "nvs_flash.h"
+#include "esp_timer.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "game_bus.h"
+#include "game_state.h"
+#include "power.h"
+#include "task_stats.h"
+#include "button_input.h"
+#include "latency.h"
+#include "console.h"
+#include "stress.h"
+#include "notifier.h"
+#include "spectator.h"
+#include "wifi_link.h"
+#include "wallclock.h"
+#include "hill_link.h"
 
 // Konstante
-#define LEFT_BUTTON_PIN 47
-#define RIGHT_BUTTON_PIN 21
 #define BUZZER_PIN 46
 #define LED_STRIP_PIN 3
 #define DISPLAY_SDA_PIN 48 // Pin za podatke displeja
@@ -36,49 +49,40 @@
 #define I2C_HOST 0
 #define DISPLAY_I2C_ADDR 0x3C
 
-#define BUZZER_EVENT_BIT (1 << 0)
-
 #define WIFI_SSID "kingofthehill"
 #define WIFI_PASS "12345678"
-#define NTFY_ENDPOINT "http://ntfy.sh/king-of-the-hill-omznc"
-
-#define DEVICE_NAME "omznc-koth"
 
-// Red za slanje poruka mrežnom zadatku
-#define QUEUE_SIZE 10
-static QueueHandle_t network_queue;
-
-// Enumeracije
-typedef enum
-{
-    GAME_OFF,
-    GAME_PLAYING,
-    GAME_FINISHED
-} GameState;
+#define BUZZER_TICK_MS 30           // Kratki zvuk svake sekunde igre
+#define BUZZER_FINISHED_MS 10000    // Dugi zvuk na kraju igre
+#define BUS_STATS_PERIOD_S 60       // Koliko često ispisati statistiku buđenja i zadataka
+
+// Raspored zadataka: Wi-Fi i mreža na jezgri 0, igra i korisnički interfejs na jezgri 1
+#define NETWORK_CORE 0
+#define UI_CORE 1
+#define INPUT_TASK_PRIORITY 13   // Obrada ivica tipki - najstroži rok
+#define CLOCK_TASK_PRIORITY 12   // Sat igre
+#define BUZZER_TASK_PRIORITY 10  // Zvuk mora pratiti sekunde igre
+#define LED_TASK_PRIORITY 9      // Frejm trake traje ~1.3 ms
+#define DISPLAY_TASK_PRIORITY 7  // Frejm displeja preko I2C traje ~25 ms, ne smije kočiti LED
+#define NETWORK_TASK_PRIORITY 5  // Ispod lwIP (18) i Wi-Fi (23) zadataka na jezgri 0
+#define DIAG_TASK_PRIORITY 1     // app_main nakon inicijalizacije samo ispisuje statistiku
+
+// Hold-to-capture: tim mora držati tipku ovoliko dugo da zauzme brdo (0 = isključeno)
+#define HOLD_TO_CAPTURE_MS 0
+#define HOLD_ANIMATION_FRAME_MS 20 // Period osvježavanja LED animacije dok se tipka drži
+#define BUTTON_DEBOUNCE_MS 20      // Ivice bliže od ovoga prethodnoj prihvaćenoj su odskakanje
+#define BUTTON_GLITCH_FILTER_NS 1000 // Smetnje na dugim kablovima kraće od ovoga se ne vide
+
+// Spam tipki: tim ne može ponovo zauzeti brdo prije isteka cooldown-a, a sva
+// zauzimanja unutar prozora se šalju kao jedna poruka sa zadnjim stanjem
+#define CAPTURE_COOLDOWN_MS 1000
+#define CAPTURE_COALESCE_MS 3000
 
-typedef enum
-{
-    NONE,
-    LEFT_RED,
-    RIGHT_BLUE,
-} TeamColor;
-
-typedef enum
-{
-    BUZZER_OFF,
-    BUZZER_SECONDS,
-    BUZZER_FINISHED
-} BuzzerState;
 
 // Globalne varijable
-static BuzzerState buzzer_state = BUZZER_OFF;
-static GameState game_state = GAME_OFF;
-static TeamColor team_color = NONE;
 static const int game_time_seconds = 900; // 15 minuta
-static int current_game_time = 0;
 static esp_lcd_panel_handle_t display_panel = NULL;
 static uint8_t led_strip_pixels[NUMBER_OF_LEDS * 4];
-static bool end_game_beep_done = false;
 static const char *TAG = "king-of-the-hill";
 
 // Eksterna referenca na podatke fonta
@@ -213,61 +217,6 @@ void draw_string(uint8_t *bitmap, int x, int y, const char *str)
 // Deklaracija za zadatak displeja
 void display_task(void *arg);
 
-// Funkcija za slanje podataka igre na NTFY endpoint
-void send_game_data(const char *message)
-{
-    esp_http_client_config_t config = {
-        .url = NTFY_ENDPOINT,
-        .method = HTTP_METHOD_POST,
-    };
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, message, strlen(message));
-
-    const int max_retries = 3;
-    const int retry_delay_ms = 2000; // 2 sekunde
-    int attempt = 0;
-    esp_err_t err;
-
-    do
-    {
-        err = esp_http_client_perform(client);
-        if (err == ESP_OK)
-        {
-            ESP_LOGI(TAG, "HTTP POST Status = %d", esp_http_client_get_status_code(client));
-            break;
-        }
-        else
-        {
-            ESP_LOGE(TAG, "HTTP POST request failed (attempt %d): %s", attempt + 1, esp_err_to_name(err));
-            vTaskDelay(pdMS_TO_TICKS(retry_delay_ms));
-        }
-        attempt++;
-    } while (attempt < max_retries);
-
-    if (err != ESP_OK)
-    {
-        ESP_LOGE(TAG, "HTTP POST request failed after %d attempts", max_retries);
-    }
-
-    esp_http_client_cleanup(client);
-}
-
-// Ažuriraj network_task da handleuje formatiranim porukama
-void network_task(void *arg)
-{
-    char message[256];
-
-    while (1)
-    {
-        if (xQueueReceive(network_queue, &message, portMAX_DELAY))
-        {
-            send_game_data(message);
-        }
-    }
-}
-
 void show_led(uint8_t r, uint8_t g, uint8_t b, uint8_t w, rmt_encoder_handle_t *led_encoder, rmt_channel_handle_t *led_chan)
 {
     // Postavi boju piksela
@@ -297,86 +246,64 @@ void set_buzzer(bool on)
 // Zadatak buzzera koji čeka događaje
 void buzzer_task(void *arg)
 {
+    game_bus_sub_t *sub = game_bus_subscribe("buzzer", GAME_EVT_START | GAME_EVT_TICK | GAME_EVT_FINISH | GAME_EVT_RESET);
+
+    set_buzzer(false);
+
     while (1)
     {
-        // Provjeri stanje igre i stanje buzzera
-        if (game_state == GAME_OFF)
+        uint32_t events = game_bus_wait(sub, portMAX_DELAY);
+
+        if (events & GAME_EVT_RESET)
         {
-            buzzer_state = BUZZER_OFF;
             set_buzzer(false);
-            end_game_beep_done = false; // Resetuj zastavicu kada je igra isključena
-            vTaskDelay(pdMS_TO_TICKS(100));
             continue;
         }
 
-        if (game_state == GAME_FINISHED && !end_game_beep_done)
+        if (events & GAME_EVT_FINISH)
         {
-            buzzer_state = BUZZER_FINISHED;
+            // Dugi zvuk na kraju igre, prekida se ako neko resetuje igru
             set_buzzer(true);
-
-            // Instead of one long delay, use shorter delays and check game state
-            int beep_time_ms = 0;
-            const int check_interval_ms = 100;
-            while (beep_time_ms < 10000 && game_state == GAME_FINISHED)
+            TickType_t start = xTaskGetTickCount();
+            TickType_t duration = pdMS_TO_TICKS(BUZZER_FINISHED_MS);
+            TickType_t elapsed;
+            while ((elapsed = xTaskGetTickCount() - start) < duration)
             {
-                vTaskDelay(pdMS_TO_TICKS(check_interval_ms));
-                beep_time_ms += check_interval_ms;
+                if (game_bus_wait(sub, duration - elapsed) & GAME_EVT_RESET)
+                {
+                    break;
+                }
             }
-
             set_buzzer(false);
-            end_game_beep_done = true; // Mark that we've done the end-game beep
-            vTaskDelay(pdMS_TO_TICKS(100));
             continue;
         }
 
-        if (game_state == GAME_PLAYING && buzzer_state != BUZZER_SECONDS)
-        {
-            buzzer_state = BUZZER_SECONDS;
-            end_game_beep_done = false; // Reset the flag when game is playing
-        }
-
-        switch (buzzer_state)
+        // Kratki zvuk na početku igre i na svaku sekundu
+        if (events & (GAME_EVT_START | GAME_EVT_TICK))
         {
-        case BUZZER_OFF:
-            set_buzzer(false);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            break;
-
-        case BUZZER_SECONDS:
             set_buzzer(true);
-            vTaskDelay(pdMS_TO_TICKS(30)); // Buzz for 10ms
+            vTaskDelay(pdMS_TO_TICKS(BUZZER_TICK_MS));
             set_buzzer(false);
-            vTaskDelay(pdMS_TO_TICKS(990)); // Wait for 990ms (total 1s)
-            break;
-
-        default:
-            vTaskDelay(pdMS_TO_TICKS(100));
-            break;
         }
     }
 }
 
 // Helper function to set LED color based on team
-void set_led_color(int index, TeamColor team_color)
+void set_led_color(int index, team_id_t team)
 {
-    if (team_color == LEFT_RED)
-    {
-        led_strip_pixels[index * 4] = 0;       // Green
-        led_strip_pixels[index * 4 + 1] = 255; // Red
-        led_strip_pixels[index * 4 + 2] = 0;   // Blue
-        led_strip_pixels[index * 4 + 3] = 0;   // White
-    }
-    else if (team_color == RIGHT_BLUE)
+    if (team == TEAM_NONE)
     {
-        led_strip_pixels[index * 4] = 0;       // Green
-        led_strip_pixels[index * 4 + 1] = 0;   // Red
-        led_strip_pixels[index * 4 + 2] = 255; // Blue
-        led_strip_pixels[index * 4 + 3] = 0;   // White
+        return;
     }
+    const team_t *color = &teams[team];
+    led_strip_pixels[index * 4] = color->g;     // Green
+    led_strip_pixels[index * 4 + 1] = color->r; // Red
+    led_strip_pixels[index * 4 + 2] = color->b; // Blue
+    led_strip_pixels[index * 4 + 3] = color->w; // White
 }
 
 // Helper function to set alternate color pattern
-void set_alternate_color(int index, TeamColor team_color)
+void set_alternate_color(int index, team_id_t team)
 {
     if ((index % 3) == 0 || (index % 3) == 1)
     {
@@ -387,58 +314,115 @@ void set_alternate_color(int index, TeamColor team_color)
     }
     else
     {
-        set_led_color(index, team_color);
+        set_led_color(index, team);
     }
 }
 
+// Prikaži koliko je dugo tim držao tipku kao brzo punjenje trake
+void show_hold_fill(const game_snapshot_t *game, rmt_encoder_handle_t *led_encoder, rmt_channel_handle_t *led_chan)
+{
+    const int64_t hold_required_us = HOLD_TO_CAPTURE_MS * 1000LL;
+    int64_t held_us = esp_timer_get_time() - game->hold_start_us;
+    int led_count = hold_required_us > 0 ? (int)(held_us * NUMBER_OF_LEDS / hold_required_us) : NUMBER_OF_LEDS;
+    if (led_count > NUMBER_OF_LEDS)
+    {
+        led_count = NUMBER_OF_LEDS;
+    }
+
+    memset(led_strip_pixels, 0, sizeof(led_strip_pixels));
+    for (int i = 0; i < led_count; i++)
+    {
+        set_led_color(i, game->hold_team);
+    }
+
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    rmt_transmit(*led_chan, *led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config);
+    rmt_tx_wait_all_done(*led_chan, portMAX_DELAY);
+}
+
 /**
  * LED zadatak
  * - Ako je igra isključena, ugasi LED
  * - Ako se igra igra (lol), prikaži boju tima kao traku napretka (s bijelom pozadinom)
  * - Ako je igra završena, prikaži boju pobjedničkog tima
+ * - Ako tim drži tipku (hold-to-capture), prikaži animaciju punjenja
  */
 void led_task(void *arg)
 {
     rmt_encoder_handle_t *led_encoder = ((LedParams *)arg)->led_encoder;
     rmt_channel_handle_t *led_chan = ((LedParams *)arg)->led_chan;
+    game_bus_sub_t *sub = game_bus_subscribe("led", GAME_EVT_START | GAME_EVT_CAPTURE | GAME_EVT_TICK | GAME_EVT_FINISH | GAME_EVT_RESET | GAME_EVT_HOLD);
+    bool strip_enabled = true; // app_main je već uključio RMT kanal
+    int64_t measured_edge_us = 0;
 
     while (1)
     {
-        if (game_state == GAME_OFF)
+        game_snapshot_t game;
+        game_state_read(&game);
+
+        // Izlazak iz mirovanja: zabrani light sleep i ponovo uključi RMT kanal
+        bool waking = !strip_enabled && (game.state != GAME_OFF || game.hold_team != TEAM_NONE);
+        if (waking)
+        {
+            power_set_active(true);
+            rmt_enable(*led_chan);
+            strip_enabled = true;
+        }
+
+        // Tim drži tipku - animiraj dok ne pusti ili ne zauzme brdo
+        if (game.hold_team != TEAM_NONE && game.state != GAME_FINISHED)
         {
-            show_led(0, 0, 0, 0, led_encoder, led_chan); // Iskljuciti LED
-            vTaskDelay(pdMS_TO_TICKS(100));
+            show_hold_fill(&game, led_encoder, led_chan);
+            if (waking)
+            {
+                power_log_wake_latency();
+            }
+            game_bus_wait(sub, pdMS_TO_TICKS(HOLD_ANIMATION_FRAME_MS));
             continue;
         }
 
-        // Ako je igra završena, prikaži pobjedničku boju
-        if (game_state == GAME_FINISHED)
+        if (game.state == GAME_OFF)
         {
-            if (team_color == LEFT_RED)
+            // Ugasi traku i pusti uređaj da spava dok neko ne pritisne tipku
+            if (strip_enabled)
             {
-                show_led(255, 0, 0, 0, led_encoder, led_chan); // Prikazi crvenu boju
+                show_led(0, 0, 0, 0, led_encoder, led_chan); // Iskljuciti LED
+                latency_record_frame(LATENCY_LED, game.commit_edge_us, &measured_edge_us);
+                rmt_disable(*led_chan);
+                strip_enabled = false;
+                power_set_active(false);
             }
-            else if (team_color == RIGHT_BLUE)
+            game_bus_wait(sub, portMAX_DELAY);
+            continue;
+        }
+
+        // Ako je igra završena, prikaži pobjedničku boju
+        if (game.state == GAME_FINISHED)
+        {
+            if (game.team != TEAM_NONE)
             {
-                show_led(0, 0, 255, 0, led_encoder, led_chan); // Prikazi plavu boju
+                const team_t *winner = &teams[game.team];
+                show_led(winner->r, winner->g, winner->b, winner->w, led_encoder, led_chan);
             }
-            vTaskDelay(pdMS_TO_TICKS(100));
+            game_bus_wait(sub, portMAX_DELAY);
             continue;
         }
 
         // Ako se igra igra, prikaži boju tima kao neki loading bar (s bijelom pozadinom)
-        int led_count = (current_game_time * NUMBER_OF_LEDS) / game_time_seconds;
+        int led_count = (game.current_game_time * NUMBER_OF_LEDS) / game_time_seconds;
         memset(led_strip_pixels, 0, sizeof(led_strip_pixels));
 
         for (int i = 0; i < NUMBER_OF_LEDS; i++)
         {
             if (i < led_count)
             {
-                set_led_color(i, team_color);
+                set_led_color(i, game.team);
             }
             else
             {
-                set_alternate_color(i, team_color);
+                set_alternate_color(i, game.team);
             }
         }
 
@@ -447,8 +431,13 @@ void led_task(void *arg)
         };
         rmt_transmit(*led_chan, *led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config);
         rmt_tx_wait_all_done(*led_chan, portMAX_DELAY);
+        latency_record_frame(LATENCY_LED, game.commit_edge_us, &measured_edge_us);
+        if (waking)
+        {
+            power_log_wake_latency();
+        }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+        game_bus_wait(sub, portMAX_DELAY);
     }
 }
 
@@ -462,14 +451,19 @@ void display_task(void *arg)
 {
     // Buffer za prikaz sadržaja
     uint8_t bitmap[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8] = {0};
+    game_bus_sub_t *sub = game_bus_subscribe("display", GAME_EVT_START | GAME_EVT_CAPTURE | GAME_EVT_TICK | GAME_EVT_FINISH | GAME_EVT_RESET | GAME_EVT_WIFI);
+    int64_t measured_edge_us = 0;
 
     while (1)
     {
+        game_snapshot_t game;
+        game_state_read(&game);
+
         // Očisti bitmapu
         memset(bitmap, 0, sizeof(bitmap));
 
         // Napravi sadržaj za prikaz na osnovi stanja igre
-        if (game_state == GAME_OFF)
+        if (game.state == GAME_OFF)
         {
             draw_string(bitmap, 16, 40, "Press to Start");
             // Prikaži status Wi-Fi-ja
@@ -483,12 +477,12 @@ void display_task(void *arg)
                 draw_string(bitmap, 20, 20, "Disconnected");
             }
         }
-        else if (game_state == GAME_PLAYING)
+        else if (game.state == GAME_PLAYING)
         {
             // Prikaži timer i trenutno pobjednički tim
             char status_line[32];
             // Izračunaj preostalo vrijeme za brojanje unazad
-            int remaining_time = game_time_seconds - current_game_time;
+            int remaining_time = game_time_seconds - game.current_game_time;
             int hours = remaining_time / 3600;
             int minutes = (remaining_time % 3600) / 60;
             int seconds = remaining_time % 60;
@@ -506,20 +500,18 @@ void display_task(void *arg)
             snprintf(status_line, sizeof(status_line), "Time: %s", time_formatted);
             draw_string(bitmap, 10, 20, status_line);
 
-            const char *winner_text = (team_color == LEFT_RED) ? "RED" : (team_color == RIGHT_BLUE) ? "BLUE"
-                                                                                                    : "NONE";
+            const char *winner_text = team_name(game.team);
 
             // Prikaži trenutno pobjednički tim
             char winning_line[32];
             snprintf(winning_line, sizeof(winning_line), "Currently: %s", winner_text);
             draw_string(bitmap, 10, 40, winning_line);
         }
-        else if (game_state == GAME_FINISHED)
+        else if (game.state == GAME_FINISHED)
         {
             // Prikaži pobjednika
             char finish_line[32];
-            const char *winner_text = (team_color == LEFT_RED) ? "RED" : (team_color == RIGHT_BLUE) ? "BLUE"
-                                                                                                    : "NONE";
+            const char *winner_text = team_name(game.team);
 
             snprintf(finish_line, sizeof(finish_line), "Finished: %s wins!", winner_text);
             draw_string(bitmap, 10, 30, finish_line);
@@ -527,134 +519,345 @@ void display_task(void *arg)
 
         // Ažuriraj displej sa našom bitmapom
         esp_lcd_panel_draw_bitmap(display_panel, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, bitmap);
+        latency_record_frame(LATENCY_DISPLAY, game.commit_edge_us, &measured_edge_us);
 
-        // Ažuriraj na razumnom nivou
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // Čekaj sljedeću promjenu stanja
+        game_bus_wait(sub, portMAX_DELAY);
     }
 }
 
-// Pomoćna funkcija za formatiranje vremena kao string
-void format_time(int remaining_time, char *buffer, size_t buffer_size)
-{
-    int minutes = remaining_time / 60;
-    int seconds = remaining_time % 60;
-    snprintf(buffer, buffer_size, "%02d:%02d", minutes, seconds);
-}
+// Vrijeme zadnjeg pritiska za svaki tim (0 = tipka nije pritisnuta)
+static int64_t press_time_us[MAX_TEAMS];
+
+// Debounce: zadnja prihvaćena ivica i stanje tipke za svaki tim
+static int64_t last_edge_us[MAX_TEAMS];
+static bool button_down[MAX_TEAMS];
+
+// Zadnje zauzimanje svakog tima (0 = nije zauzimao), za cooldown
+static int64_t last_capture_us[MAX_TEAMS];
 
-// Handler za pritisak tipke (oba tipka)
-void IRAM_ATTR button_isr_handler(void *arg)
+// Zauzimanja koja čekaju zajedničku poruku i kada prozor ističe
+static int pending_captures = 0;
+static int64_t capture_flush_us = 0;
+
+// Obrada jedne ivice tipke (bilo kojeg tima) - pravila igre i poruke
+void handle_button_edge(const button_edge_t *edge)
 {
-    // Obrada pritisaka tipke
-    int pin = (int)arg;
+    int pin = edge->pin;
+    int64_t edge_us = edge->time_us;
+    team_id_t pressed = team_from_pin(pin);
+    uint32_t events = 0;
 
-    // Ako je igra završena, resetiraj igru
-    if (game_state == GAME_FINISHED)
+    power_note_edge(edge_us);
+    if (pressed == TEAM_NONE)
     {
-        game_state = GAME_OFF;
-        team_color = NONE;
-        current_game_time = 0;
-        // send_game_data WITH GAME OVER: Winner <team>
-        char end_message[256];
-        snprintf(end_message, sizeof(end_message), "GAME OVER: %s has won!",
-                 team_color == LEFT_RED ? "RED" : "BLUE");
-        xQueueSend(network_queue, &end_message, portMAX_DELAY);
+        return;
+    }
 
+    // Tipke su na pull-up, pa pritisak spušta pin na 0
+    bool down = edge->level == 0;
+
+    // Odskakanje: ista ivica kao prethodna, ili preblizu prethodnoj (stres test u capture načinu ga preskače)
+    bool direct = edge->flags & BUTTON_EDGE_DIRECT;
+    if (down == button_down[pressed] || (!direct && edge_us - last_edge_us[pressed] < BUTTON_DEBOUNCE_MS * 1000LL))
+    {
         return;
     }
+    button_down[pressed] = down;
+    last_edge_us[pressed] = edge_us;
 
-    // Ako je igra isključena, pokreni igru i postavi boju tima
-    if (game_state == GAME_OFF)
+    if (down)
     {
-        game_state = GAME_PLAYING;
-        current_game_time = 0; // Resetiraj vrijeme kada se pokrene igra
-        buzzer_state = BUZZER_SECONDS;
-        if (pin == LEFT_BUTTON_PIN)
+        button_input_count_press();
+        press_time_us[pressed] = edge_us;
+
+        // Igra će vjerovatno krenuti kad tim pusti tipku, pripremi konekciju za poruku
+        game_snapshot_t current;
+        game_state_read(&current);
+        if (current.state == GAME_OFF)
         {
-            team_color = LEFT_RED;
+            notifier_prewarm();
         }
-        else if (pin == RIGHT_BUTTON_PIN)
+
+        // Za hold-to-capture pokreni animaciju ako bi ovaj pritisak promijenio stanje
+        if (HOLD_TO_CAPTURE_MS > 0)
         {
-            team_color = RIGHT_BLUE;
-        }
+            game_snapshot_t *game = game_state_write_begin();
+            if (game->state != GAME_FINISHED && game->team != pressed)
+            {
+                game->hold_team = pressed;
+                game->hold_start_us = edge_us;
+                events = GAME_EVT_HOLD;
+            }
+            game_state_write_end();
 
-        char message[256];
-        snprintf(message, sizeof(message), "%s took the hill. GAME STARTED!",
-                 team_color == LEFT_RED ? "RED" : "BLUE");
-        xQueueSend(network_queue, &message, portMAX_DELAY);
+            if (events)
+            {
+                game_bus_publish(events);
+            }
+        }
         return;
     }
 
-    // Inače samo postavi boju tima
-    if (game_state == GAME_PLAYING)
+    // Otpuštanje: koliko je tipka držana, mjereno između dvije ivice
+    int64_t held_us = press_time_us[pressed] ? edge_us - press_time_us[pressed] : 0;
+    bool held_long_enough = held_us >= HOLD_TO_CAPTURE_MS * 1000LL;
+    press_time_us[pressed] = 0;
+
+    // Promijeni stanje igre; poruka se pravi tek nakon što je stanje objavljeno
+    game_snapshot_t *game = game_state_write_begin();
+    game_snapshot_t before = *game;
+    if (game->hold_team == pressed)
+    {
+        game->hold_team = TEAM_NONE;
+        events |= GAME_EVT_HOLD;
+    }
+
+    if (game->state == GAME_FINISHED)
+    {
+        // Ako je igra završena, resetiraj igru
+        game->state = GAME_OFF;
+        game->team = TEAM_NONE;
+        game->current_game_time = 0;
+        events |= GAME_EVT_RESET;
+        game->commit_edge_us = edge_us;
+    }
+    else if (game->state == GAME_OFF && held_long_enough)
+    {
+        // Ako je igra isključena, pokreni igru i postavi boju tima
+        game->state = GAME_PLAYING;
+        game->current_game_time = 0; // Resetiraj vrijeme kada se pokrene igra
+        game->team = pressed;
+        game->start_us = edge_us;
+        game->tick_us = edge_us;
+        memset(game->hold_seconds, 0, sizeof(game->hold_seconds));
+        events |= GAME_EVT_START;
+        game->commit_edge_us = edge_us;
+    }
+    else if (game->state == GAME_PLAYING && game->team != pressed && held_long_enough &&
+             (direct || last_capture_us[pressed] == 0 ||
+              edge_us - last_capture_us[pressed] >= CAPTURE_COOLDOWN_MS * 1000LL))
+    {
+        // Inače samo postavi boju tima (osim ako trenutni tim pritisne svoju tipku)
+        game->team = pressed;
+        events |= GAME_EVT_CAPTURE;
+        game->commit_edge_us = edge_us;
+    }
+    game_state_write_end();
+
+    if (events & (GAME_EVT_RESET | GAME_EVT_START | GAME_EVT_CAPTURE))
+    {
+        latency_record(LATENCY_COMMIT, (uint32_t)(esp_timer_get_time() - edge_us));
+    }
+    if (events & (GAME_EVT_START | GAME_EVT_CAPTURE))
+    {
+        last_capture_us[pressed] = edge_us;
+    }
+
+    // Poruke se formatiraju tek u mrežnom zadatku, ovdje ide samo događaj
+    if (events & GAME_EVT_RESET)
+    {
+        notifier_post(NOTIFY_GAME_OVER, before.team, 0, 0);
+    }
+    else if (events & GAME_EVT_START)
     {
-        // Guard statement ako trenutni tim pritisne svoju tipku
-        if (team_color == LEFT_RED && pin == LEFT_BUTTON_PIN)
+        notifier_post(NOTIFY_GAME_STARTED, pressed, game_time_seconds, 0);
+    }
+    else if (events & GAME_EVT_CAPTURE)
+    {
+        // Poruka ide tek kad prozor istekne, sa timom koji tada drži brdo
+        if (pending_captures++ == 0)
         {
-            return;
+            capture_flush_us = edge_us + CAPTURE_COALESCE_MS * 1000LL;
         }
-        else if (team_color == RIGHT_BLUE && pin == RIGHT_BUTTON_PIN)
+    }
+    if (events & (GAME_EVT_RESET | GAME_EVT_START))
+    {
+        // Zaostala zauzimanja iz prethodne igre se ne šalju, GAME OVER već kaže ko je pobijedio
+        pending_captures = 0;
+    }
+
+    if (events)
+    {
+        game_bus_publish(events);
+    }
+}
+
+// Pošalji jednu poruku za sva zauzimanja iz prozora, ako igra još traje
+void flush_capture_message(void)
+{
+    game_snapshot_t game;
+    game_state_read(&game);
+
+    if (game.state == GAME_PLAYING)
+    {
+        notifier_post(NOTIFY_CAPTURED, game.team, game_time_seconds - game.current_game_time, pending_captures);
+    }
+    pending_captures = 0;
+}
+
+/**
+ * Zadatak za tipke
+ * - ISR samo bilježi ivice u prsten i budi ovaj zadatak
+ * - Ovdje se radi debounce, pravila igre i slanje poruka
+ * - Zauzimanja se skupljaju CAPTURE_COALESCE_MS i šalju kao jedna poruka
+ */
+void input_task(void *arg)
+{
+    // Prekidi se obrađuju na jezgri koja ih instalira, pa tipke idu ovdje na UI jezgru
+    int pins[MAX_TEAMS];
+    for (int i = 0; i < team_count; i++)
+    {
+        pins[i] = teams[i].pin;
+    }
+    if (button_input_enable_glitch_filter(pins, team_count, BUTTON_GLITCH_FILTER_NS) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "No GPIO glitch filter, relying on debounce only");
+    }
+    ESP_ERROR_CHECK(button_input_start(pins, team_count));
+
+    // Stres test ubacuje ivice sa ove jezgre, u isti prsten
+    if (stress_init() != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Stress test unavailable");
+    }
+
+    while (1)
+    {
+        // Spavaj do sljedeće ivice, ili dok ne istekne prozor za poruku o zauzimanju
+        TickType_t wait = portMAX_DELAY;
+        if (pending_captures > 0)
         {
-            return;
+            int64_t remaining_us = capture_flush_us - esp_timer_get_time();
+            wait = remaining_us > 0 ? pdMS_TO_TICKS(remaining_us / 1000) + 1 : 0;
         }
+        ulTaskNotifyTake(pdTRUE, wait);
 
-        if (pin == LEFT_BUTTON_PIN)
+        button_edge_t edge;
+        while (button_input_pop(&edge))
         {
-            team_color = LEFT_RED;
+            handle_button_edge(&edge);
         }
-        else if (pin == RIGHT_BUTTON_PIN)
+
+        if (pending_captures > 0 && esp_timer_get_time() >= capture_flush_us)
         {
-            team_color = RIGHT_BLUE;
+            flush_capture_message();
         }
-        // send_game_data sa trenutnom bojom tima
-        char message[256];
-        char time_buffer[16];
-        format_time(game_time_seconds - current_game_time, time_buffer, sizeof(time_buffer));
-        snprintf(message, sizeof(message), "%s took the hill! Time left: %s",
-                 team_color == LEFT_RED ? "RED" : "BLUE", time_buffer);
-        xQueueSend(network_queue, &message, portMAX_DELAY);
     }
 }
 
-// Handler za Wi-Fi događaje
-static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+/**
+ * Zajednički početak sa agregatora (zove ga esp_timer u trenutku start_us)
+ * - Igra počinje bez tima; brdo dobije prvi tim koji zadrži tipku
+ * - Igra koja već traje se ne prekida
+ */
+void start_synced_game(int64_t start_us)
 {
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    game_snapshot_t *game = game_state_write_begin();
+    bool started = game->state != GAME_PLAYING;
+    if (started)
     {
-        esp_wifi_connect();
+        game->state = GAME_PLAYING;
+        game->current_game_time = 0;
+        game->team = TEAM_NONE;
+        game->start_us = start_us;
+        game->tick_us = start_us;
+        memset(game->hold_seconds, 0, sizeof(game->hold_seconds));
     }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    game_state_write_end();
+
+    if (started)
     {
-        esp_wifi_connect();
-        ESP_LOGI(TAG, "Retrying connection to Wi-Fi");
+        notifier_post(NOTIFY_GAME_STARTED, TEAM_NONE, game_time_seconds, 0);
+        game_bus_publish(GAME_EVT_START);
     }
 }
 
-// Inicijaliziraj Wi-Fi
-void wifi_init(void)
+// FreeRTOS tick je 10 ms, pa sekunde igre odbrojava esp_timer, da brda ostanu poravnata na ~1 ms
+static SemaphoreHandle_t clock_tick = NULL;
+
+static void clock_timer_callback(void *arg)
 {
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    xSemaphoreGive(clock_tick);
+}
 
-    esp_netif_create_default_wifi_sta();
+/**
+ * Sat igre
+ * - Dok igra ne traje, spava do početka igre
+ * - Svake sekunde pomjeri vrijeme, objavi polovinu igre i kraj
+ * - Sekunda n je u start_us + n s (ili po satu agregatora), pa se kašnjenje ne skuplja
+ */
+void game_clock_task(void *arg)
+{
+    game_bus_sub_t *sub = game_bus_subscribe("clock", GAME_EVT_START);
+    esp_timer_handle_t clock_timer;
+    const esp_timer_create_args_t timer_args = {
+        .callback = clock_timer_callback,
+        .name = "game_clock",
+    };
+    clock_tick = xSemaphoreCreateBinary();
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &clock_timer));
 
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    while (1)
+    {
+        game_snapshot_t current;
+        game_state_read(&current);
+        if (current.state != GAME_PLAYING)
+        {
+            game_bus_wait(sub, portMAX_DELAY);
+            continue;
+        }
 
-    esp_event_handler_instance_t instance_any_id;
-    esp_event_handler_instance_t instance_got_ip;
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
+        int64_t deadline_us = hill_link_tick_deadline(current.start_us, current.current_game_time + 1);
+        int64_t delay_us = deadline_us - esp_timer_get_time();
+        if (delay_us > 0)
+        {
+            esp_timer_start_once(clock_timer, delay_us);
+            xSemaphoreTake(clock_tick, portMAX_DELAY);
+        }
 
-    wifi_config_t wifi_config = {
-        .sta = {
-            .ssid = WIFI_SSID,
-            .password = WIFI_PASS,
-            .threshold.authmode = WIFI_AUTH_OPEN,
-        },
-    };
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
+        // Pomjeri sat igre; poruke se šalju tek kad je novo stanje objavljeno
+        uint32_t events = 0;
+        game_snapshot_t *game = game_state_write_begin();
+        game_snapshot_t before = *game;
+        // Zajednički početak je mogao pokrenuti novu igru dok je sat čekao
+        if (game->state == GAME_PLAYING && game->start_us == current.start_us)
+        {
+            events = GAME_EVT_TICK;
+            if (game->current_game_time == game_time_seconds / 2)
+            {
+                events |= GAME_EVT_HALFWAY;
+            }
+            if (game->current_game_time < game_time_seconds)
+            {
+                game->current_game_time++;
+                game->tick_us = deadline_us;
+                if (game->team != TEAM_NONE)
+                {
+                    game->hold_seconds[game->team]++;
+                }
+            }
+            else
+            {
+                game->state = GAME_FINISHED;
+                events |= GAME_EVT_FINISH;
+            }
+        }
+        game_state_write_end();
+
+        if (events & GAME_EVT_HALFWAY)
+        {
+            notifier_post(NOTIFY_HALFWAY, before.team, game_time_seconds - before.current_game_time, 0);
+        }
+        if (events & GAME_EVT_FINISH)
+        {
+            notifier_post(NOTIFY_GAME_OVER, before.team, 0, 0);
+        }
+        if (events)
+        {
+            game_bus_publish(events);
+        }
+    }
 }
 
 void app_main(void)
@@ -668,6 +871,14 @@ void app_main(void)
         nvs_ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(nvs_ret);
+
+    // Wi-Fi prvo, da se povezivanje odvija dok se inicijalizuju traka i displej
+    wifi_link_start(WIFI_SSID, WIFI_PASS);
+    wallclock_start();
+
+    // Napravi red za mrežu i zadatak odmah, da prva poruka ne čeka ostatak inicijalizacije
+    notifier_start(NETWORK_CORE, NETWORK_TASK_PRIORITY);
+
     ESP_LOGI(TAG, "Create RMT TX channel");
     rmt_channel_handle_t led_chan = NULL;
     rmt_tx_channel_config_t tx_chan_config = {
@@ -725,17 +936,15 @@ void app_main(void)
     ESP_ERROR_CHECK(esp_lcd_panel_init(display_panel));
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(display_panel, true));
 
-    // Inicijaliziraj Wi-Fi
-    wifi_init();
-
     // Napravi zadatak za displej
-    xTaskCreate(
+    xTaskCreatePinnedToCore(
         display_task,
         "display_task",
         4096, // Veći stack za operacije sa stringovima
         NULL,
-        10,
-        NULL);
+        DISPLAY_TASK_PRIORITY,
+        NULL,
+        UI_CORE);
 
     // Inicijaliziraj GPIO za zvonec
     gpio_config_t io_conf = {
@@ -747,78 +956,73 @@ void app_main(void)
     };
     gpio_config(&io_conf);
 
-    // Inicijaliziraj GPIO za tipke
+    // Inicijaliziraj GPIO za tipke svih timova iz tabele
+    teams_init();
     gpio_config_t button_configs = {
-        .pin_bit_mask = (1ULL << LEFT_BUTTON_PIN) | (1ULL << RIGHT_BUTTON_PIN),
+        .pin_bit_mask = teams_button_mask(),
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_POSEDGE,
+        // Prekid na nivo (ISR ga okreće nakon svake ivice), jer samo nivo može buditi iz light sleep-a
+        .intr_type = GPIO_INTR_LOW_LEVEL,
     };
     gpio_config(&button_configs);
 
+    // Light sleep dok igra miruje, tipke bude uređaj
+    power_init(button_configs.pin_bit_mask);
+
     // Napravi objekt za zadatak za zvonce
     LedParams led_params = {
         .led_encoder = &led_encoder,
         .led_chan = &led_chan};
 
     // Napravi zadatak za zvonce s 100ms intervalom
-    xTaskCreate(
+    xTaskCreatePinnedToCore(
         (TaskFunction_t)buzzer_task,
         "buzzer_task",
         2048,
         NULL,
-        10,
-        NULL);
+        BUZZER_TASK_PRIORITY,
+        NULL,
+        UI_CORE);
 
     // Napravi zadatak za LED traku
-    xTaskCreate(
+    xTaskCreatePinnedToCore(
         (TaskFunction_t)led_task,
         "led_task",
         2048,
         &led_params,
-        10,
-        NULL);
-    // Napravi red za mrežu i zadatak
-    network_queue = xQueueCreate(QUEUE_SIZE, sizeof(char[256]));
-    xTaskCreate(network_task, "network_task", 4096, NULL, 10, NULL);
+        LED_TASK_PRIORITY,
+        NULL,
+        UI_CORE);
+    // HTTP API i SSE tok za gledaoce
+    spectator_start(game_time_seconds, NETWORK_CORE, NETWORK_TASK_PRIORITY);
+    // Stanje ostalih brda na terenu (samo ako je uloga zadana pri build-u)
+    hill_link_start(game_time_seconds, start_synced_game, NETWORK_CORE, NETWORK_TASK_PRIORITY);
 
-    // Postavi upravljače za prekid tipke
-    gpio_install_isr_service(0);
-    gpio_isr_handler_add(LEFT_BUTTON_PIN, button_isr_handler, (void *)LEFT_BUTTON_PIN);
-    gpio_isr_handler_add(RIGHT_BUTTON_PIN, button_isr_handler, (void *)RIGHT_BUTTON_PIN);
+    // Napravi zadatak za tipke i sat igre
+    xTaskCreatePinnedToCore(input_task, "input_task", 4096, NULL, INPUT_TASK_PRIORITY, NULL, UI_CORE);
+    xTaskCreatePinnedToCore(game_clock_task, "game_clock", 4096, NULL, CLOCK_TASK_PRIORITY, NULL, UI_CORE);
 
     // Očisti sve pixele
     memset(led_strip_pixels, 0, sizeof(led_strip_pixels));
 
-    // Održavaj program u pokretu
+    // Serijska konzola za čitanje i resetovanje statistike
+    console_start();
+
+    // Dalje app_main samo periodično ispisuje buđenja, kašnjenja i udio CPU-a po zadatku
+    vTaskPrioritySet(NULL, DIAG_TASK_PRIORITY);
     while (1)
     {
-        if (game_state == GAME_PLAYING)
-        {
-            if (current_game_time == game_time_seconds / 2)
-            {
-                static char halfway_message[256];
-                char time_buffer[16];
-                format_time(game_time_seconds - current_game_time, time_buffer, sizeof(time_buffer));
-                snprintf(halfway_message, sizeof(halfway_message), "HALFWAY: %s is holding the hill, time left: %s",
-                         team_color == LEFT_RED ? "RED" : "BLUE", time_buffer);
-                xQueueSend(network_queue, &halfway_message, portMAX_DELAY);
-            }
-            if (current_game_time < game_time_seconds)
-            {
-                current_game_time++;
-            }
-            else
-            {
-                game_state = GAME_FINISHED;
-                static char end_message[256];
-                snprintf(end_message, sizeof(end_message), "GAME OVER: %s has won!",
-                         team_color == LEFT_RED ? "RED" : "BLUE");
-                xQueueSend(network_queue, &end_message, portMAX_DELAY);
-            }
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        vTaskDelay(pdMS_TO_TICKS(BUS_STATS_PERIOD_S * 1000));
+        game_bus_log_stats();
+        button_input_log_stats();
+        task_stats_log();
+        power_log_stats();
+        wifi_link_log_stats();
+        wallclock_log_stats();
+        notifier_log_stats();
+        spectator_log_stats();
+        hill_link_log_stats();
     }
 }
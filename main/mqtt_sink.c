@@ -0,0 +1,200 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+#include "latency.h"
+#include "notify_format.h"
+#include "notify_sink.h"
+
+static const char *TAG = "mqtt_sink";
+
+// Bira se sa idf.py -DMQTT_BROKER_URI=mqtt://<ip>:1883 build; poruke se prate sa
+// mosquitto_sub -h <ip> -v -t 'king-of-the-hill/#'
+#ifndef MQTT_BROKER_URI
+#define MQTT_BROKER_URI "mqtt://localhost:1883"
+#endif
+
+#ifndef MQTT_TOPIC_PREFIX
+#define MQTT_TOPIC_PREFIX "king-of-the-hill"
+#endif
+
+// QoS 1: broker potvrđuje prijem (PUBACK), tek tad se događaj briše iz outbox-a.
+// Sa QoS 0 događaj se briše čim ga esp-mqtt preda TCP-u (najviše jednom).
+#ifndef MQTT_QOS
+#define MQTT_QOS 1
+#endif
+
+// Koliko dugo čekati PUBACK za paket prije nego što se ponovi
+#define MQTT_ACK_TIMEOUT_MS 5000
+
+#define MQTT_EVENTS_TOPIC MQTT_TOPIC_PREFIX "/events"
+#define MQTT_HOLDER_TOPIC MQTT_TOPIC_PREFIX "/holder" // Zadržana poruka: tim koji trenutno drži brdo
+
+static esp_mqtt_client_handle_t client = NULL;
+static volatile bool connected = false;
+
+static uint32_t published = 0;
+static uint32_t failures = 0;
+static uint32_t ack_timeouts = 0;
+
+// Potvrde koje su stigle od početka slanja paketa (i za zadržane holder poruke)
+#define MQTT_ACKS_MAX (2 * NOTIFY_SINK_MAX_BATCH)
+static int acked_ids[MQTT_ACKS_MAX];
+static int acked_count = 0;
+static portMUX_TYPE ack_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t ack_signal = NULL; // Stigla je potvrda ili je konekcija pala
+
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    if (event_id == MQTT_EVENT_CONNECTED)
+    {
+        connected = true;
+        ESP_LOGI(TAG, "Connected to %s", MQTT_BROKER_URI);
+    }
+    else if (event_id == MQTT_EVENT_DISCONNECTED)
+    {
+        connected = false;
+        xSemaphoreGive(ack_signal);
+    }
+    else if (event_id == MQTT_EVENT_PUBLISHED)
+    {
+        esp_mqtt_event_handle_t event = event_data;
+        portENTER_CRITICAL(&ack_lock);
+        if (acked_count < MQTT_ACKS_MAX)
+        {
+            acked_ids[acked_count++] = event->msg_id;
+        }
+        portEXIT_CRITICAL(&ack_lock);
+        xSemaphoreGive(ack_signal);
+    }
+}
+
+// Broj poruka iz msg_ids za koje još nije stigao PUBACK
+static int missing_acks(const int *msg_ids, int count)
+{
+    int missing = 0;
+    portENTER_CRITICAL(&ack_lock);
+    for (int i = 0; i < count; i++)
+    {
+        bool found = false;
+        for (int j = 0; j < acked_count && !found; j++)
+        {
+            found = acked_ids[j] == msg_ids[i];
+        }
+        missing += !found;
+    }
+    portEXIT_CRITICAL(&ack_lock);
+    return missing;
+}
+
+// Čekaj da broker potvrdi sve događaje iz paketa
+static bool wait_for_acks(const int *msg_ids, int count)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(MQTT_ACK_TIMEOUT_MS);
+
+    while (missing_acks(msg_ids, count) > 0)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (!connected || elapsed >= timeout)
+        {
+            return false;
+        }
+        xSemaphoreTake(ack_signal, timeout - elapsed);
+    }
+    return true;
+}
+
+static esp_err_t mqtt_sink_init(void)
+{
+    ack_signal = xSemaphoreCreateBinary();
+    if (ack_signal == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_mqtt_client_config_t config = {
+        .broker.address.uri = MQTT_BROKER_URI,
+    };
+    client = esp_mqtt_client_init(&config);
+    if (client == NULL)
+    {
+        return ESP_FAIL;
+    }
+
+    esp_mqtt_client_register_event(client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+    // Klijent sam ponovo uspostavlja konekciju kad Wi-Fi proradi
+    return esp_mqtt_client_start(client);
+}
+
+// Svaki događaj je jedna poruka; tim iz događaja je i novi zadržani "holder".
+// Uspjeh se vraća tek kad broker potvrdi sve događaje; inače se cijeli paket
+// ponovi kasnije, pa pretplatnik može dobiti duplikat (isti seq).
+static esp_err_t mqtt_sink_send(const notify_event_t *events, int count)
+{
+    int msg_ids[NOTIFY_SINK_MAX_BATCH];
+    int sent = 0;
+
+    if (!connected)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&ack_lock);
+    acked_count = 0;
+    portEXIT_CRITICAL(&ack_lock);
+    xSemaphoreTake(ack_signal, 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        const notify_event_t *event = &events[i];
+        char json[160];
+        int length = notify_format_json(event, json, sizeof(json));
+        if (length < 0)
+        {
+            continue; // Nepoznat tip događaja
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        int msg_id = esp_mqtt_client_publish(client, MQTT_EVENTS_TOPIC, json, length, MQTT_QOS, 0);
+        if (msg_id < 0)
+        {
+            failures++;
+            return ESP_FAIL;
+        }
+        latency_record(LATENCY_MQTT_PUBLISH, (uint32_t)(esp_timer_get_time() - start_us));
+        msg_ids[sent++] = msg_id;
+
+        // Događaji sa drugih brda ne mijenjaju ko drži ovo brdo
+        if (event->type != NOTIFY_HILL_CAPTURED && event->type != NOTIFY_HILL_GAME_OVER)
+        {
+            const char *holder = team_name(event->team);
+            esp_mqtt_client_publish(client, MQTT_HOLDER_TOPIC, holder, 0, MQTT_QOS, 1);
+        }
+        published++;
+    }
+
+    // QoS 0 nema PUBACK
+    if (MQTT_QOS > 0 && !wait_for_acks(msg_ids, sent))
+    {
+        ack_timeouts++;
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+static void mqtt_sink_log_stats(void)
+{
+    ESP_LOGI(TAG, "%s, %lu events published, %lu failures, %lu batches without PUBACK",
+             connected ? "connected" : "disconnected", (unsigned long)published, (unsigned long)failures,
+             (unsigned long)ack_timeouts);
+}
+
+const notify_sink_t mqtt_sink = {
+    .name = "mqtt",
+    .init = mqtt_sink_init,
+    .prewarm = NULL, // Konekcija je stalno otvorena
+    .send = mqtt_sink_send,
+    .log_stats = mqtt_sink_log_stats,
+};
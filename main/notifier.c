@@ -0,0 +1,360 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "notifier.h"
+#include "notify_queue.h"
+#include "notify_sink.h"
+#include "outbox.h"
+#include "wallclock.h"
+
+static const char *TAG = "notifier";
+
+_Static_assert(sizeof(notify_event_t) <= OUTBOX_PAYLOAD_SIZE, "Event does not fit in one outbox record");
+
+// Događaji koji stignu zajedno upisuju se u outbox jednim upisom i predaju transportu odjednom
+#define NOTIFIER_BATCH_LINGER_MS 100 // Koliko dugo nakon prve poruke čekati na ostale
+
+// Neuspjelo slanje se ponavlja sa eksponencijalnim odmakom, poruke čekaju u outbox-u
+#define NOTIFIER_BACKOFF_BASE_MS 1000
+#define NOTIFIER_BACKOFF_MAX_MS 30000
+
+// Transport se bira pri build-u: MQTT ako je zadan broker, inače ntfy.
+// Član terena ne objavljuje ništa, da iste poruke ne stižu i od njega i od agregatora.
+#ifdef HILL_LINK_MEMBER
+static const notify_sink_t *sink = NULL;
+#elif defined(MQTT_BROKER_URI)
+static const notify_sink_t *sink = &mqtt_sink;
+#else
+static const notify_sink_t *sink = &ntfy_sink;
+#endif
+
+static volatile bool connected = false;   // Wi-Fi ima IP adresu
+static volatile bool reconnected = false; // Mreža se vratila, ne čekaj odmak
+
+// Stanje ponovnih pokušaja za najstarije poruke u outbox-u
+static int failed_attempts = 0;
+static int64_t next_try_us = 0;
+
+// Statistika
+static uint32_t retry_attempts = 0;
+static uint32_t max_delivery_age_ms = 0; // Od događaja do uspješnog slanja, od zadnjeg ispisa
+static uint32_t rejected_events = 0;     // Server ih je trajno odbio, pa su obrisani
+
+// Server je odbio paket, pa se toliko zapisa šalje jedan po jedan da se nađe loš
+static int isolate_records = 0;
+
+// Pola odmaka je fiksno, pola nasumično, da se ponovni pokušaji ne poklope sa ostalim uređajima
+static int64_t backoff_us(int attempts)
+{
+    uint32_t ceiling_ms = NOTIFIER_BACKOFF_MAX_MS;
+    if (attempts <= 5)
+    {
+        ceiling_ms = NOTIFIER_BACKOFF_BASE_MS << (attempts - 1);
+    }
+    if (ceiling_ms > NOTIFIER_BACKOFF_MAX_MS)
+    {
+        ceiling_ms = NOTIFIER_BACKOFF_MAX_MS;
+    }
+    uint32_t delay_ms = ceiling_ms / 2 + esp_random() % (ceiling_ms / 2 + 1);
+    return delay_ms * 1000LL;
+}
+
+// Prolazna greška slanja: outbox čeka sve duže prije sljedećeg pokušaja
+static void back_off(const char *what, esp_err_t err)
+{
+    failed_attempts++;
+    int64_t delay_us = backoff_us(failed_attempts);
+    next_try_us = esp_timer_get_time() + delay_us;
+    ESP_LOGW(TAG, "%s %d failed (%s), %lu messages waiting, retrying in %lld ms", what, failed_attempts,
+             esp_err_to_name(err), (unsigned long)outbox_pending(), delay_us / 1000);
+}
+
+// Upiši događaj i sve koji stignu u kratkom roku u outbox, jednim upisom u flash
+static void store_batch(const notify_event_t *first)
+{
+    notify_event_t event;
+    TickType_t batch_start = xTaskGetTickCount();
+
+    outbox_append(first, sizeof(*first));
+    while (1)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - batch_start;
+        TickType_t linger = pdMS_TO_TICKS(NOTIFIER_BATCH_LINGER_MS);
+        if (!notify_queue_pop(&event, elapsed < linger ? linger - elapsed : 0))
+        {
+            break;
+        }
+        // Prewarm se preskače, konekcija se ionako otvara za slanje
+        if (event.type != NOTIFY_PREWARM)
+        {
+            outbox_append(&event, sizeof(event));
+        }
+    }
+
+    esp_err_t err = outbox_flush();
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to store messages: %s", esp_err_to_name(err));
+    }
+}
+
+// Predaj najstarije događaje iz outbox-a transportu, najviše NOTIFY_SINK_MAX_BATCH odjednom
+static bool send_oldest(void)
+{
+    notify_event_t events[NOTIFY_SINK_MAX_BATCH];
+    uint8_t payload[OUTBOX_PAYLOAD_SIZE];
+    size_t payload_length;
+    int count = 0;
+    bool oldest_this_boot = false;
+    outbox_cursor_t cursor;
+    int batch_limit = isolate_records > 0 ? 1 : NOTIFY_SINK_MAX_BATCH;
+
+    outbox_cursor_begin(&cursor);
+    while (count < batch_limit && outbox_next(&cursor, payload, &payload_length))
+    {
+        if (payload_length != sizeof(notify_event_t))
+        {
+            continue; // Zapis iz nepoznatog formata, samo ga preskoči
+        }
+
+        notify_event_t *event = &events[count];
+        memcpy(event, payload, sizeof(*event));
+        if (event->type == NOTIFY_PREWARM || event->type >= NOTIFY_TYPE_COUNT)
+        {
+            continue;
+        }
+        // esp_timer vrijeme iz prethodnog boot-a se ne može pretvoriti; šalje se bez UTC-a (nepoznato)
+        if (cursor.this_boot)
+        {
+            notifier_event_to_utc(event);
+        }
+        if (count == 0)
+        {
+            oldest_this_boot = cursor.this_boot;
+        }
+        count++;
+    }
+    if (count == 0)
+    {
+        // Ostali su samo nečitljivi zapisi
+        outbox_consume(&cursor);
+        return false;
+    }
+
+    if (failed_attempts > 0)
+    {
+        retry_attempts++;
+    }
+    esp_err_t err = sink->send(events, count);
+    if (err == NOTIFY_SINK_REJECTED && count > 1)
+    {
+        // Ne zna se koji je događaj loš; ostali ne smiju čekati iza njega
+        isolate_records = count;
+        ESP_LOGW(TAG, "Server rejected a batch of %d, sending them one at a time", count);
+        return true;
+    }
+    if (err != ESP_OK && err != NOTIFY_SINK_REJECTED)
+    {
+        back_off("Attempt", err);
+        return false;
+    }
+
+    outbox_consume(&cursor);
+    failed_attempts = 0;
+    next_try_us = 0;
+    if (isolate_records > 0)
+    {
+        isolate_records--;
+    }
+    if (err == NOTIFY_SINK_REJECTED)
+    {
+        rejected_events++;
+        ESP_LOGW(TAG, "Server rejected event %u (type %d), dropped it", events[0].seq, events[0].type);
+        return true;
+    }
+
+    // Najstariji događaj je prvi; bez UTC-a se ne zna starost događaja iz prethodnog boot-a
+    int64_t now = esp_timer_get_time();
+    int64_t oldest_us = events[0].time_us;
+    bool utc = events[0].flags & NOTIFY_FLAG_UTC;
+    if (utc)
+    {
+        now = wallclock_utc_us(now);
+    }
+    if ((utc || oldest_this_boot) && now != 0 && oldest_us <= now)
+    {
+        uint32_t age_ms = (uint32_t)((now - oldest_us) / 1000);
+        if (age_ms > max_delivery_age_ms)
+        {
+            max_delivery_age_ms = age_ms;
+        }
+    }
+    return true;
+}
+
+// Koliko dugo red smije čekati prije nego što outbox treba slati
+static TickType_t next_send_wait(void)
+{
+    if (!connected || outbox_pending() == 0)
+    {
+        return portMAX_DELAY;
+    }
+    int64_t remaining_us = next_try_us - esp_timer_get_time();
+    return remaining_us > 0 ? pdMS_TO_TICKS(remaining_us / 1000) + 1 : 0;
+}
+
+static void notifier_task(void *arg)
+{
+    notify_event_t event;
+
+    ESP_LOGI(TAG, "Sending notifications over %s", sink->name);
+    ESP_ERROR_CHECK(sink->init());
+    ESP_ERROR_CHECK(outbox_init());
+
+    while (1)
+    {
+        // Novi događaji se odmah upisuju, čak i dok se stari ponavljaju
+        bool popped = notify_queue_pop(&event, next_send_wait());
+
+        if (reconnected)
+        {
+            reconnected = false;
+            failed_attempts = 0;
+            next_try_us = 0;
+        }
+
+        if (popped)
+        {
+            if (event.type == NOTIFY_PREWARM)
+            {
+                // Server koji ne odgovara na prewarm ni poruke ne bi primio odmah
+                esp_err_t err = sink->prewarm != NULL ? sink->prewarm() : ESP_OK;
+                if (err != ESP_OK && err != NOTIFY_SINK_REJECTED)
+                {
+                    back_off("Prewarm", err);
+                }
+            }
+            else
+            {
+                store_batch(&event);
+            }
+        }
+
+        // Prazni outbox po redu dok ima mreže i dok slanje uspijeva
+        while (connected && outbox_pending() > 0 && esp_timer_get_time() >= next_try_us && send_oldest())
+        {
+        }
+    }
+}
+
+void notifier_start(BaseType_t core, UBaseType_t priority)
+{
+    if (sink == NULL)
+    {
+        ESP_LOGI(TAG, "Hill member: notifications are published by the aggregator");
+        return;
+    }
+    ESP_ERROR_CHECK(notify_queue_init());
+    xTaskCreatePinnedToCore(notifier_task, "network_task", 4096, NULL, priority, NULL, core);
+}
+
+// Dodijeli vrijeme i stavi u red; redni broj dodjeljuje red
+static void post(notify_event_t *event)
+{
+    if (sink == NULL)
+    {
+        return;
+    }
+    event->time_us = esp_timer_get_time();
+    notifier_event_to_utc(event);
+    if (!notify_queue_push(event))
+    {
+        ESP_LOGW(TAG, "Notification queue full, dropped event %d", event->type);
+    }
+}
+
+void notifier_post(notify_type_t type, team_id_t team, int remaining_s, int captures)
+{
+    notify_event_t event = {
+        .type = type,
+        .team = team,
+        .remaining_s = (uint16_t)remaining_s,
+        .captures = (uint8_t)(captures < UINT8_MAX ? captures : UINT8_MAX),
+    };
+    post(&event);
+}
+
+void notifier_post_hill(notify_type_t type, uint16_t hill_id, team_id_t team, int remaining_s)
+{
+    notify_event_t event = {
+        .type = type,
+        .team = team,
+        .remaining_s = (uint16_t)remaining_s,
+        .hill_id = hill_id,
+    };
+    post(&event);
+}
+
+bool notifier_event_to_utc(notify_event_t *event)
+{
+    if (event->flags & NOTIFY_FLAG_UTC)
+    {
+        return true;
+    }
+    int64_t utc_us = wallclock_utc_us(event->time_us);
+    if (utc_us == 0)
+    {
+        return false;
+    }
+    event->time_us = utc_us;
+    event->flags |= NOTIFY_FLAG_UTC;
+    return true;
+}
+
+void notifier_prewarm(void)
+{
+    if (sink == NULL)
+    {
+        return;
+    }
+    const notify_event_t event = {
+        .type = NOTIFY_PREWARM,
+    };
+    notify_queue_push(&event);
+}
+
+void notifier_set_connected(bool is_connected)
+{
+    connected = is_connected;
+    if (is_connected)
+    {
+        // Probudi zadatak da odmah pošalje sve što je na čekanju
+        reconnected = true;
+        notifier_prewarm();
+    }
+}
+
+void notifier_log_stats(void)
+{
+    notify_queue_stats_t queue_stats;
+    notify_queue_get_stats(&queue_stats);
+
+    if (sink == NULL)
+    {
+        return;
+    }
+    sink->log_stats();
+    outbox_log_stats();
+    ESP_LOGI(TAG, "Queue: %lu posted, %lu collapsed, %lu evicted, %lu dropped (%lu critical), high-water %lu/%d",
+             (unsigned long)queue_stats.posted, (unsigned long)queue_stats.collapsed,
+             (unsigned long)queue_stats.evicted, (unsigned long)queue_stats.dropped,
+             (unsigned long)queue_stats.dropped_critical, (unsigned long)queue_stats.high_water,
+             NOTIFY_QUEUE_SIZE + NOTIFY_QUEUE_RESERVE);
+    ESP_LOGI(TAG, "%s, %lu retries, %d failed attempts in a row, %lu rejected, worst delivery age %lu ms",
+             connected ? "online" : "offline", (unsigned long)retry_attempts, failed_attempts,
+             (unsigned long)rejected_events, (unsigned long)max_delivery_age_ms);
+    max_delivery_age_ms = 0;
+}
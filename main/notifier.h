@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "teams.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ime uređaja u porukama, da se razlikuju brda na istom terenu
+#ifndef DEVICE_NAME
+#define DEVICE_NAME "omznc-koth"
+#endif
+
+typedef enum
+{
+    NOTIFY_PREWARM,      // Nije poruka - samo otvori konekciju unaprijed
+    NOTIFY_GAME_STARTED, // team je zauzeo brdo i pokrenuo igru
+    NOTIFY_CAPTURED,     // team drži brdo nakon captures zauzimanja
+    NOTIFY_HALFWAY,      // Pola igre, team drži brdo
+    NOTIFY_GAME_OVER,    // team je pobijedio
+    // Događaji sa drugih brda (samo agregator), brdo je u hill_id
+    NOTIFY_HILL_CAPTURED,  // team je zauzeo drugo brdo
+    NOTIFY_HILL_GAME_OVER, // team je pobijedio na drugom brdu
+    NOTIFY_TYPE_COUNT,
+} notify_type_t;
+
+// Događaj u redu i u outbox-u (16 bajta); tekst poruke pravi tek mrežni zadatak
+typedef struct
+{
+    uint8_t type : 4;     // notify_type_t
+    uint8_t flags : 4;    // NOTIFY_FLAG_*
+    team_id_t team;
+    uint16_t remaining_s; // Preostalo vrijeme igre
+    union
+    {
+        uint8_t captures; // Zauzimanja spojena u ovu poruku (NOTIFY_CAPTURED), najviše 255
+        uint16_t hill_id; // NOTIFY_HILL_*: zadnja dva bajta MAC adrese brda, isti poslije reseta
+    };
+    uint16_t seq;         // Redni broj od paljenja; spojeni događaji nose broj prvog, pa rupa znači izgubljenu poruku
+    int64_t time_us;      // UTC ako je NOTIFY_FLAG_UTC, inače esp_timer vrijeme događaja (boot-a u kojem je nastao)
+} notify_event_t;
+
+_Static_assert(NOTIFY_TYPE_COUNT <= 16, "notify_type_t does not fit in 4 bits");
+
+// time_us je UTC (mikrosekunde od 1970), a ne esp_timer vrijeme
+#define NOTIFY_FLAG_UTC (1 << 0)
+
+/**
+ * @brief Napravi red poruka i mrežni zadatak koji ih šalje na ntfy
+ *
+ * Svaka poruka se prvo upiše u outbox u flash-u i briše tek kad je
+ * poslana, pa preživi prekid mreže i reset uređaja. Brdo koje je član
+ * terena (-DHILL_LINK=member) ne šalje ništa: poruke za cijeli teren
+ * objavljuje agregator iz stanja koje mu brda šalju.
+ */
+void notifier_start(BaseType_t core, UBaseType_t priority);
+
+/**
+ * @brief Stavi događaj u red za slanje; nikad ne čeka
+ *
+ * Pod opterećenjem red spaja zauzimanja i izbacuje manje važne poruke,
+ * vidi notify_queue_push().
+ */
+void notifier_post(notify_type_t type, team_id_t team, int remaining_s, int captures);
+
+/**
+ * @brief Stavi u red događaj sa drugog brda (NOTIFY_HILL_*)
+ *
+ * @param hill_id Zadnja dva bajta MAC adrese brda, vidi hill_link_id()
+ */
+void notifier_post_hill(notify_type_t type, uint16_t hill_id, team_id_t team, int remaining_s);
+
+/**
+ * @brief Pretvori esp_timer vrijeme događaja u UTC ako je sat u međuvremenu sinhronizovan
+ *
+ * Samo za događaje iz ovog boot-a: esp_timer vrijeme iz prethodnog se
+ * ne može pretvoriti, a ni prepoznati po vrijednosti.
+ *
+ * @return false ako UTC vrijeme događaja nije poznato
+ */
+bool notifier_event_to_utc(notify_event_t *event);
+
+/**
+ * @brief Zatraži otvaranje konekcije prije nego što poruka zatreba
+ *
+ * Ne čeka ako je red pun. Sigurno je pozvati i prije notifier_start().
+ */
+void notifier_prewarm(void);
+
+/**
+ * @brief Javi da li Wi-Fi ima IP adresu; outbox se prazni samo dok je ima
+ */
+void notifier_set_connected(bool connected);
+
+/**
+ * @brief Ispiši ponovne pokušaje, stanje outbox-a i starost poruka na čekanju
+ */
+void notifier_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "hill_link.h"
+#include "json_writer.h"
+#include "notify_format.h"
+
+static const char *event_names[] = {
+    [NOTIFY_GAME_STARTED] = "started",
+    [NOTIFY_CAPTURED] = "captured",
+    [NOTIFY_HALFWAY] = "halfway",
+    [NOTIFY_GAME_OVER] = "game_over",
+    [NOTIFY_HILL_CAPTURED] = "hill_captured",
+    [NOTIFY_HILL_GAME_OVER] = "hill_game_over",
+};
+
+// Ime drugog brda, sastavljeno iz id-a kao u hill_link_start()
+static const char *hill_name(const notify_event_t *event, char *buffer, size_t size)
+{
+    snprintf(buffer, size, HILL_NAME_FORMAT, DEVICE_NAME, event->hill_id);
+    return buffer;
+}
+
+static const char *event_name(const notify_event_t *event)
+{
+    if (event->type >= sizeof(event_names) / sizeof(event_names[0]))
+    {
+        return NULL;
+    }
+    return event_names[event->type];
+}
+
+int notify_format_text(const notify_event_t *event, char *buffer, size_t size)
+{
+    char hill[16];
+    char time_left[8];
+    snprintf(time_left, sizeof(time_left), "%02d:%02d", event->remaining_s / 60, event->remaining_s % 60);
+
+    switch (event->type)
+    {
+    case NOTIFY_GAME_STARTED:
+        if (event->team == TEAM_NONE)
+        {
+            return snprintf(buffer, size, "GAME STARTED on all hills!");
+        }
+        return snprintf(buffer, size, "%s took the hill. GAME STARTED!", team_name(event->team));
+    case NOTIFY_CAPTURED:
+        if (event->captures > 1)
+        {
+            return snprintf(buffer, size, "%s holds the hill after %u captures! Time left: %s",
+                            team_name(event->team), event->captures, time_left);
+        }
+        return snprintf(buffer, size, "%s took the hill! Time left: %s", team_name(event->team), time_left);
+    case NOTIFY_HALFWAY:
+        return snprintf(buffer, size, "HALFWAY: %s is holding the hill, time left: %s", team_name(event->team), time_left);
+    case NOTIFY_GAME_OVER:
+        return snprintf(buffer, size, "GAME OVER: %s has won!", team_name(event->team));
+    case NOTIFY_HILL_CAPTURED:
+        return snprintf(buffer, size, "%s took hill %s! Time left: %s", team_name(event->team),
+                        hill_name(event, hill, sizeof(hill)), time_left);
+    case NOTIFY_HILL_GAME_OVER:
+        return snprintf(buffer, size, "GAME OVER on hill %s: %s has won!", hill_name(event, hill, sizeof(hill)),
+                        team_name(event->team));
+    default:
+        return 0;
+    }
+}
+
+int notify_format_json(const notify_event_t *event, char *buffer, size_t size)
+{
+    const char *name = event_name(event);
+    char hill[16];
+    json_writer_t writer;
+
+    if (name == NULL)
+    {
+        return -1;
+    }
+
+    json_writer_init(&writer, buffer, size);
+    json_object_begin(&writer);
+    json_key(&writer, "event");
+    json_string(&writer, name);
+    json_key(&writer, "team");
+    json_string(&writer, team_name(event->team));
+    json_key(&writer, "remaining_ms");
+    json_int(&writer, event->remaining_s * 1000LL);
+    if (event->type == NOTIFY_CAPTURED)
+    {
+        json_key(&writer, "captures");
+        json_int(&writer, event->captures);
+    }
+    if (event->type == NOTIFY_HILL_CAPTURED || event->type == NOTIFY_HILL_GAME_OVER)
+    {
+        json_key(&writer, "hill");
+        json_string(&writer, hill_name(event, hill, sizeof(hill)));
+    }
+    // null: vrijeme nije poznato (događaj prije SNTP-a ili iz prethodnog boot-a)
+    json_key(&writer, "utc_ms");
+    if (event->flags & NOTIFY_FLAG_UTC)
+    {
+        json_int(&writer, event->time_us / 1000);
+    }
+    else
+    {
+        json_null(&writer);
+    }
+    json_key(&writer, "seq");
+    json_int(&writer, event->seq);
+    json_key(&writer, "device");
+    json_string(&writer, DEVICE_NAME);
+    json_object_end(&writer);
+    return json_writer_finish(&writer);
+}
+
+// Isti objekat preko snprintf, bez escape-a - samo za poređenje
+static int format_json_snprintf(const notify_event_t *event, char *buffer, size_t size)
+{
+    char hill[16];
+    int length = snprintf(buffer, size, "{\"event\":\"%s\",\"team\":\"%s\",\"remaining_ms\":%lld", event_name(event),
+                          team_name(event->team), event->remaining_s * 1000LL);
+    if (event->type == NOTIFY_CAPTURED && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"captures\":%u", event->captures);
+    }
+    if ((event->type == NOTIFY_HILL_CAPTURED || event->type == NOTIFY_HILL_GAME_OVER) && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"hill\":\"%s\"",
+                           hill_name(event, hill, sizeof(hill)));
+    }
+    if ((event->flags & NOTIFY_FLAG_UTC) && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"utc_ms\":%lld", (long long)(event->time_us / 1000));
+    }
+    else if ((size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"utc_ms\":null");
+    }
+    if ((size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"seq\":%u,\"device\":\"%s\"}", event->seq, DEVICE_NAME);
+    }
+    return length;
+}
+
+void notify_format_benchmark(uint32_t iterations)
+{
+    static const struct
+    {
+        const char *name;
+        int (*format)(const notify_event_t *event, char *buffer, size_t size);
+    } methods[] = {
+        {"json writer", notify_format_json},
+        {"json snprintf", format_json_snprintf},
+        {"text snprintf", notify_format_text},
+    };
+    notify_event_t event = {
+        .type = NOTIFY_CAPTURED,
+        .team = 0,
+        .remaining_s = 450,
+        .captures = 2,
+        .seq = 17,
+    };
+    char buffer[160];
+    char expected[160];
+
+    // Poređenje ima smisla samo ako obje JSON metode daju iste bajtove
+    notify_format_json(&event, expected, sizeof(expected));
+    format_json_snprintf(&event, buffer, sizeof(buffer));
+    if (strcmp(expected, buffer) != 0)
+    {
+        printf("json snprintf differs from json writer:\n  %s\n  %s\n", buffer, expected);
+        return;
+    }
+
+    for (int m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+    {
+        // volatile da kompajler ne izbaci formatiranje iz petlje
+        volatile int total = 0;
+        int64_t start_us = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            event.seq = (uint16_t)i;
+            total += methods[m].format(&event, buffer, sizeof(buffer));
+        }
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+        printf("%-14s %6lu ns/message  %s\n", methods[m].name, (unsigned long)(elapsed_us * 1000 / iterations), buffer);
+        (void)total;
+    }
+}
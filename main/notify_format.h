@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tekst poruke za ljude, npr. "RED took the hill! Time left: 07:30"
+ *
+ * @return Dužina kao snprintf (može biti >= size ako je skraćeno), 0 za nepoznat tip
+ */
+int notify_format_text(const notify_event_t *event, char *buffer, size_t size);
+
+/**
+ * @brief JSON objekat događaja za mašine, bez heap-a
+ *
+ * {"event":"captured","team":"RED","remaining_ms":450000,"captures":2,"utc_ms":1792108800123,
+ *  "seq":17,"device":"omznc-koth"}
+ *
+ * utc_ms izostaje ako sat nije bio sinhronizovan.
+ *
+ * @return Dužina, ili -1 ako ne stane ili je tip nepoznat
+ */
+int notify_format_json(const notify_event_t *event, char *buffer, size_t size);
+
+/**
+ * @brief Izmjeri JSON pisac, ekvivalentan snprintf i tekstualni format
+ *
+ * Ispisuje prosječno vrijeme po poruci za svaki način.
+ */
+void notify_format_benchmark(uint32_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "notify_queue.h"
+
+#define NOTIFY_QUEUE_CAPACITY (NOTIFY_QUEUE_SIZE + NOTIFY_QUEUE_RESERVE)
+
+// Važnost događaja kad red nema mjesta
+typedef enum
+{
+    PRIORITY_INFO,     // Polovina igre, prewarm - prvi se izbacuju
+    PRIORITY_CAPTURE,  // Zauzimanja - mogu se spojiti
+    PRIORITY_CRITICAL, // Početak i kraj igre - uvijek prolaze
+} notify_priority_t;
+
+// Događaji po redu dolaska; mali niz, pa je pomjeranje jeftinije od prstena sa rupama
+static notify_event_t entries[NOTIFY_QUEUE_CAPACITY];
+static int count = 0;
+static notify_queue_stats_t stats;
+
+// Spojeni događaj ne dobija novi broj, pa rupa u seq znači samo izbačen ili odbijen događaj
+static uint16_t next_seq = 0;
+
+// Pisci su ulazni zadatak i sat igre, čitalac mrežni zadatak
+static portMUX_TYPE queue_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t ready = NULL;
+
+static notify_priority_t priority_of(uint8_t type)
+{
+    switch (type)
+    {
+    case NOTIFY_GAME_STARTED:
+    case NOTIFY_GAME_OVER:
+    case NOTIFY_HILL_GAME_OVER:
+        return PRIORITY_CRITICAL;
+    case NOTIFY_CAPTURED:
+    case NOTIFY_HILL_CAPTURED:
+        return PRIORITY_CAPTURE;
+    default:
+        return PRIORITY_INFO;
+    }
+}
+
+static void remove_at(int index)
+{
+    memmove(&entries[index], &entries[index + 1], (count - index - 1) * sizeof(entries[0]));
+    count--;
+}
+
+// Spoji događaj sa zadnjim u redu ako je istog tipa, da se redoslijed različitih događaja ne promijeni
+static bool collapse(const notify_event_t *event)
+{
+    if (event->type == NOTIFY_PREWARM)
+    {
+        // Prewarm ne nosi stanje, dovoljan je jedan bilo gdje u redu
+        for (int i = 0; i < count; i++)
+        {
+            if (entries[i].type == NOTIFY_PREWARM)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (count == 0 || entries[count - 1].type != event->type)
+    {
+        return false;
+    }
+
+    notify_event_t *queued = &entries[count - 1];
+    if (event->type == NOTIFY_CAPTURED)
+    {
+        // Zadnje stanje, ukupan broj zauzimanja, vrijeme prvog (za starost isporuke)
+        queued->team = event->team;
+        queued->remaining_s = event->remaining_s;
+        int captures = queued->captures + event->captures;
+        queued->captures = captures < UINT8_MAX ? captures : UINT8_MAX;
+        return true;
+    }
+    if (event->type == NOTIFY_HILL_CAPTURED && queued->hill_id == event->hill_id)
+    {
+        // Isto brdo: važi samo zadnji tim koji ga drži
+        queued->team = event->team;
+        queued->remaining_s = event->remaining_s;
+        return true;
+    }
+    return false;
+}
+
+// Najstariji događaj najmanje važnosti koji je manje važan od novog, ili -1
+static int find_victim(notify_priority_t priority)
+{
+    int victim = -1;
+    notify_priority_t victim_priority = priority;
+
+    for (int i = 0; i < count; i++)
+    {
+        notify_priority_t queued_priority = priority_of(entries[i].type);
+        if (queued_priority < victim_priority)
+        {
+            victim = i;
+            victim_priority = queued_priority;
+        }
+    }
+    return victim;
+}
+
+esp_err_t notify_queue_init(void)
+{
+    ready = xSemaphoreCreateBinary();
+    return ready != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+bool notify_queue_push(const notify_event_t *event)
+{
+    notify_priority_t priority = priority_of(event->type);
+    bool accepted = true;
+
+    portENTER_CRITICAL(&queue_lock);
+    stats.posted++;
+    if (collapse(event))
+    {
+        stats.collapsed++;
+    }
+    else
+    {
+        // Prewarm nije poruka, pa ne troši broj
+        uint16_t seq = event->type == NOTIFY_PREWARM ? 0 : next_seq++;
+        int limit = priority == PRIORITY_CRITICAL ? NOTIFY_QUEUE_CAPACITY : NOTIFY_QUEUE_SIZE;
+        // Kad rezerva drži početak ili kraj igre, treba izbaciti i više od jednog
+        int victim;
+        while (count >= limit && (victim = find_victim(priority)) >= 0)
+        {
+            remove_at(victim);
+            stats.evicted++;
+        }
+
+        if (count < limit)
+        {
+            entries[count] = *event;
+            entries[count++].seq = seq;
+            if (count > stats.high_water)
+            {
+                stats.high_water = count;
+            }
+        }
+        else
+        {
+            accepted = false;
+            stats.dropped++;
+            if (priority == PRIORITY_CRITICAL)
+            {
+                stats.dropped_critical++;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&queue_lock);
+
+    // Prewarm može stići i prije notify_queue_init()
+    if (accepted && ready != NULL)
+    {
+        xSemaphoreGive(ready);
+    }
+    return accepted;
+}
+
+bool notify_queue_pop(notify_event_t *event, TickType_t timeout)
+{
+    // Rok se računa od poziva, pa buđenje bez događaja ne produžava čekanje
+    TimeOut_t start;
+    vTaskSetTimeOutState(&start);
+
+    while (1)
+    {
+        bool found = false;
+        portENTER_CRITICAL(&queue_lock);
+        if (count > 0)
+        {
+            *event = entries[0];
+            remove_at(0);
+            found = true;
+        }
+        portEXIT_CRITICAL(&queue_lock);
+
+        if (found)
+        {
+            return true;
+        }
+        // Semafor može ostati dat od događaja koji je već uzet, pa se provjerava ponovo
+        if (xTaskCheckForTimeOut(&start, &timeout) == pdTRUE || xSemaphoreTake(ready, timeout) != pdTRUE)
+        {
+            return false;
+        }
+    }
+}
+
+void notify_queue_get_stats(notify_queue_stats_t *out)
+{
+    portENTER_CRITICAL(&queue_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&queue_lock);
+}
+
+void notify_queue_clear_high_water(void)
+{
+    portENTER_CRITICAL(&queue_lock);
+    stats.high_water = count;
+    portEXIT_CRITICAL(&queue_lock);
+}
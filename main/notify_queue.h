@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mjesta za sve događaje; GAME STARTED i GAME OVER imaju još NOTIFY_QUEUE_RESERVE samo za sebe
+#define NOTIFY_QUEUE_SIZE 10
+#define NOTIFY_QUEUE_RESERVE 4
+
+typedef struct
+{
+    uint32_t posted;           // Događaji predani redu
+    uint32_t collapsed;        // Spojeni sa istim događajem koji već čeka (zauzimanja, prewarm)
+    uint32_t evicted;          // Izbačeni iz reda da naprave mjesta važnijem događaju
+    uint32_t dropped;          // Odbijeni jer je red pun važnijih događaja
+    uint32_t dropped_critical; // GAME STARTED / GAME OVER odbijeni (puna i rezerva)
+    uint32_t high_water;       // Najviše događaja koji su istovremeno čekali
+} notify_queue_stats_t;
+
+/**
+ * @brief Napravi red događaja za mrežni zadatak
+ */
+esp_err_t notify_queue_init(void);
+
+/**
+ * @brief Stavi događaj u red; nikad ne blokira
+ *
+ * Redoslijed čekanja je redoslijed događaja. Kad je red pun, prvo se
+ * izbacuju informativni događaji (polovina igre, prewarm), pa zauzimanja;
+ * novo zauzimanje se spaja sa zadnjim događajem u redu ako je i on
+ * zauzimanje (istog brda), pa se redoslijed ne mijenja. GAME STARTED i
+ * GAME OVER imaju rezervna mjesta i izbacuju sve ostalo.
+ *
+ * Red dodjeljuje seq (event->seq se ne gleda): spojeni događaj zadrži
+ * broj prvog, a svaki koji se ne spoji dobije novi, i kad bude odbijen.
+ * Rupa u seq kod primaoca je zato uvijek izgubljena poruka.
+ *
+ * @return false ako događaj nije ušao u red
+ */
+bool notify_queue_push(const notify_event_t *event);
+
+/**
+ * @brief Uzmi najstariji događaj, čekaj najviše timeout
+ *
+ * Poziva ga samo mrežni zadatak.
+ *
+ * @return false ako je timeout istekao bez događaja
+ */
+bool notify_queue_pop(notify_event_t *event, TickType_t timeout);
+
+/**
+ * @brief Kopiraj brojače reda
+ */
+void notify_queue_get_stats(notify_queue_stats_t *stats);
+
+/**
+ * @brief Počni iznova mjeriti najveću popunjenost reda
+ */
+void notify_queue_clear_high_water(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "esp_err.h"
+#include "notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Najviše događaja koje mrežni zadatak predaje transportu odjednom
+#define NOTIFY_SINK_MAX_BATCH 12
+
+// Server je odbio događaje i ponavljanje ne bi pomoglo (npr. HTTP 4xx)
+#define NOTIFY_SINK_REJECTED ESP_ERR_INVALID_RESPONSE
+
+/**
+ * @brief Transport kojim mrežni zadatak šalje događaje (ntfy preko HTTP-a, MQTT, ...)
+ *
+ * Sve funkcije se pozivaju samo iz mrežnog zadatka.
+ */
+typedef struct
+{
+    const char *name;
+
+    // Pripremi transport; poziva se jednom, prije prvog slanja
+    esp_err_t (*init)(void);
+
+    // Otvori konekciju unaprijed ako transport to traži (može biti NULL); greške kao kod send
+    esp_err_t (*prewarm)(void);
+
+    // Pošalji događaje po redu; ESP_OK znači da se smiju obrisati iz outbox-a,
+    // NOTIFY_SINK_REJECTED da ih je server trajno odbio, a ostalo da se ponove kasnije
+    esp_err_t (*send)(const notify_event_t *events, int count);
+
+    // Ispiši statistiku transporta
+    void (*log_stats)(void);
+} notify_sink_t;
+
+extern const notify_sink_t ntfy_sink;
+extern const notify_sink_t mqtt_sink;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "latency.h"
+#include "ntfy_client.h"
+
+static const char *TAG = "ntfy_client";
+
+#define NTFY_TIMEOUT_MS 5000
+
+// TCP keepalive otkriva mrtvu konekciju dok čeka sljedeću poruku
+#define NTFY_KEEPALIVE_IDLE_S 30
+#define NTFY_KEEPALIVE_INTERVAL_S 5
+#define NTFY_KEEPALIVE_COUNT 3
+
+static esp_http_client_handle_t client = NULL;
+
+// Prethodni zahtjev je uspio, pa bi konekcija trebala biti otvorena
+static bool connected = false;
+
+static uint32_t messages = 0;
+static uint32_t requests = 0;
+static uint32_t reconnects = 0;
+static uint32_t failures = 0;
+static uint32_t rejections = 0; // Odgovori van 2xx
+
+esp_err_t ntfy_client_init(const char *url, const char *content_type)
+{
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = NTFY_TIMEOUT_MS,
+        .keep_alive_enable = true,
+        .keep_alive_idle = NTFY_KEEPALIVE_IDLE_S,
+        .keep_alive_interval = NTFY_KEEPALIVE_INTERVAL_S,
+        .keep_alive_count = NTFY_KEEPALIVE_COUNT,
+    };
+    client = esp_http_client_init(&config);
+    if (client == NULL)
+    {
+        return ESP_FAIL;
+    }
+
+    esp_http_client_set_header(client, "Content-Type", content_type);
+    ESP_LOGI(TAG, "Notifications go to %s", url);
+    return ESP_OK;
+}
+
+// Izvrši zahtjev; na staroj konekciji greška znači da ju je server zatvorio
+static esp_err_t perform(void)
+{
+    bool reused = connected;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = esp_http_client_perform(client);
+
+    if (err != ESP_OK && reused)
+    {
+        esp_http_client_close(client);
+        reconnects++;
+        reused = false;
+        start_us = esp_timer_get_time();
+        err = esp_http_client_perform(client);
+    }
+
+    requests++;
+    if (err == ESP_OK)
+    {
+        latency_record(reused ? LATENCY_HTTP_REUSED : LATENCY_HTTP_NEW, (uint32_t)(esp_timer_get_time() - start_us));
+        connected = true;
+    }
+    else
+    {
+        failures++;
+        esp_http_client_close(client);
+        connected = false;
+    }
+    return err;
+}
+
+// Samo 2xx je uspjeh; 408, 429 i 5xx su prolazni, ostali odgovori trajno odbijaju zahtjev
+static esp_err_t check_status(const char *method)
+{
+    int status = esp_http_client_get_status_code(client);
+    if (status >= 200 && status < 300)
+    {
+        return ESP_OK;
+    }
+
+    rejections++;
+    bool transient = status == 408 || status == 429 || status >= 500;
+    ESP_LOGW(TAG, "HTTP %s Status = %d (%s)", method, status, transient ? "retrying later" : "rejected");
+    return transient ? ESP_FAIL : ESP_ERR_INVALID_RESPONSE;
+}
+
+esp_err_t ntfy_client_post(const char *body, size_t length, int message_count)
+{
+    if (client == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+    esp_http_client_set_post_field(client, body, length);
+    esp_err_t err = perform();
+    if (err == ESP_OK)
+    {
+        err = check_status("POST");
+    }
+    if (err == ESP_OK)
+    {
+        messages += message_count;
+        ESP_LOGI(TAG, "HTTP POST Status = %d (%d messages)", esp_http_client_get_status_code(client), message_count);
+    }
+    return err;
+}
+
+esp_err_t ntfy_client_prewarm(void)
+{
+    if (client == NULL || connected)
+    {
+        return ESP_OK;
+    }
+
+    esp_http_client_set_method(client, HTTP_METHOD_HEAD);
+    esp_http_client_set_post_field(client, NULL, 0);
+    esp_err_t err = perform();
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+
+    if (err == ESP_OK)
+    {
+        err = check_status("HEAD");
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Prewarm failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+void ntfy_client_log_stats(void)
+{
+    ESP_LOGI(TAG, "%lu messages in %lu requests, %lu reconnects, %lu failures, %lu non-2xx responses",
+             (unsigned long)messages, (unsigned long)requests, (unsigned long)reconnects, (unsigned long)failures,
+             (unsigned long)rejections);
+}
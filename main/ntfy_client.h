@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Napravi jedan HTTP klijent koji ostaje otvoren između poruka
+ *
+ * Poziva se samo iz mrežnog zadatka; klijent nije siguran za više zadataka.
+ *
+ * @param url Adresa ntfy teme (ili lokalnog zamjenskog servera za testiranje)
+ * @param content_type Content-Type tijela svih zahtjeva
+ */
+esp_err_t ntfy_client_init(const char *url, const char *content_type);
+
+/**
+ * @brief Pošalji poruku (ili više njih, jednu po redu) preko postojeće konekcije
+ *
+ * Ako je server u međuvremenu zatvorio konekciju, otvara novu i odmah
+ * ponavlja zahtjev jednom.
+ *
+ * @param message_count Broj poruka u tijelu, za statistiku
+ * @return ESP_OK samo za 2xx odgovor; ESP_FAIL za grešku konekcije, 408,
+ *         429 i 5xx (vrijedi ponoviti kasnije); ESP_ERR_INVALID_RESPONSE
+ *         za ostale 4xx odgovore, koje ponavljanje ne bi popravilo
+ */
+esp_err_t ntfy_client_post(const char *body, size_t length, int message_count);
+
+/**
+ * @brief Otvori konekciju unaprijed (DNS + TCP) ako nije već otvorena
+ *
+ * Šalje HEAD zahtjev na istu adresu, pa prva prava poruka ne čeka na
+ * uspostavljanje konekcije. Odgovor se provjerava kao kod
+ * ntfy_client_post().
+ */
+esp_err_t ntfy_client_prewarm(void);
+
+/**
+ * @brief Ispiši broj poslanih poruka, zahtjeva, ponovnih konekcija i grešaka
+ *
+ * Trajanja zahtjeva su u histogramima "http new" i "http reused"
+ * (komanda latency na konzoli).
+ */
+void ntfy_client_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#include "notify_format.h"
+#include "notify_sink.h"
+#include "ntfy_client.h"
+
+// Za testiranje sa lokalnim serverom: idf.py -DNTFY_ENDPOINT=http://<ip>:8080/koth build
+#ifndef NTFY_ENDPOINT
+#define NTFY_ENDPOINT "http://ntfy.sh/king-of-the-hill-omznc"
+#endif
+
+// Tijelo je tekst za ljude na telefonu; sa -DNTFY_BODY_JSON=1 ide jedan JSON objekat po redu
+#ifdef NTFY_BODY_JSON
+#define NTFY_CONTENT_TYPE "application/x-ndjson"
+#define NTFY_LINE_SIZE 160
+#else
+#define NTFY_CONTENT_TYPE "text/plain"
+#define NTFY_LINE_SIZE 80 // Najduža poruka je ~60 znakova
+#endif
+#define NTFY_BATCH_BYTES (NOTIFY_SINK_MAX_BATCH * NTFY_LINE_SIZE)
+
+static int format_line(const notify_event_t *event, char *buffer, size_t size)
+{
+#ifdef NTFY_BODY_JSON
+    return notify_format_json(event, buffer, size);
+#else
+    return notify_format_text(event, buffer, size);
+#endif
+}
+
+static esp_err_t ntfy_sink_init(void)
+{
+    return ntfy_client_init(NTFY_ENDPOINT, NTFY_CONTENT_TYPE);
+}
+
+// Svi događaji idu u jedan POST, jedna poruka po redu
+static esp_err_t ntfy_sink_send(const notify_event_t *events, int count)
+{
+    static char batch[NTFY_BATCH_BYTES];
+    size_t length = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (length > 0)
+        {
+            batch[length++] = '\n';
+        }
+        int line_length = format_line(&events[i], batch + length, NTFY_LINE_SIZE);
+        if (line_length < 0)
+        {
+            line_length = 0; // JSON nije stao u red
+        }
+        else if (line_length >= NTFY_LINE_SIZE)
+        {
+            line_length = NTFY_LINE_SIZE - 1; // snprintf je skratio red
+        }
+        length += line_length;
+    }
+    return ntfy_client_post(batch, length, count);
+}
+
+const notify_sink_t ntfy_sink = {
+    .name = "ntfy",
+    .init = ntfy_sink_init,
+    .prewarm = ntfy_client_prewarm,
+    .send = ntfy_sink_send,
+    .log_stats = ntfy_client_log_stats,
+};
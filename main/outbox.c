@@ -0,0 +1,295 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "outbox.h"
+
+static const char *TAG = "outbox";
+
+#define OUTBOX_PARTITION_LABEL "outbox"
+#define OUTBOX_PARTITION_SUBTYPE 0x40
+#define OUTBOX_SECTOR_SIZE 4096
+#define RECORDS_PER_SECTOR (OUTBOX_SECTOR_SIZE / OUTBOX_RECORD_SIZE)
+
+#define BLANK 0xFFFFFFFF // Obrisan flash
+
+// Prsten zapisa koji se samo dodaju; sektor se briše tek kad ga pisanje ponovo dostigne
+typedef struct
+{
+    uint32_t seq;      // Redni broj, raste sa svakim zapisom (BLANK = prazno mjesto)
+    uint32_t consumed; // BLANK dok zapis nije poslan, 0 kad jeste (bitovi se samo brišu, bez brisanja sektora)
+    uint16_t length;
+    uint16_t reserved;
+    uint32_t crc; // CRC32 od seq, length i sadržaja
+    uint8_t payload[OUTBOX_PAYLOAD_SIZE];
+} outbox_record_t;
+
+_Static_assert(sizeof(outbox_record_t) == OUTBOX_RECORD_SIZE, "Outbox record layout changed");
+
+static const esp_partition_t *partition = NULL;
+static uint32_t record_count = 0;
+
+static uint32_t write_index = 0; // Sljedeće prazno mjesto
+static uint32_t tail_index = 0;  // Najstariji zapis koji možda nije poslan
+static uint32_t next_seq = 0;
+static uint32_t boot_seq = 0; // Prvi redni broj upisan u ovom boot-u
+static uint32_t pending = 0;
+
+// Zapisi koji čekaju jedan zajednički upis
+static outbox_record_t buffer[OUTBOX_WRITE_BATCH];
+static int buffered = 0;
+
+// Statistika
+static uint32_t records_written = 0;
+static uint32_t sectors_erased = 0;
+static uint32_t records_lost = 0;
+
+static uint32_t record_crc(const outbox_record_t *record)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&record->seq, sizeof(record->seq));
+    crc = esp_rom_crc32_le(crc, (const uint8_t *)&record->length, sizeof(record->length));
+    return esp_rom_crc32_le(crc, record->payload, record->length);
+}
+
+static bool read_record(uint32_t index, outbox_record_t *record)
+{
+    if (esp_partition_read(partition, index * OUTBOX_RECORD_SIZE, record, sizeof(*record)) != ESP_OK)
+    {
+        return false;
+    }
+    return record->seq != BLANK && record->length <= OUTBOX_PAYLOAD_SIZE && record->crc == record_crc(record);
+}
+
+static bool is_pending(const outbox_record_t *record)
+{
+    return record->consumed == BLANK;
+}
+
+// Obriši sektor prije pisanja u njega; neposlani zapisi u njemu se gube
+static esp_err_t erase_sector(uint32_t first_index)
+{
+    outbox_record_t record;
+    uint32_t lost = 0;
+
+    if (pending > 0)
+    {
+        for (uint32_t i = first_index; i < first_index + RECORDS_PER_SECTOR; i++)
+        {
+            if (read_record(i, &record) && is_pending(&record))
+            {
+                lost++;
+            }
+        }
+    }
+
+    // Brisanje traje desetine ms i gasi keš; tad rade samo IRAM prekidi (tipke jesu, ostali čekaju)
+    esp_err_t err = esp_partition_erase_range(partition, first_index * OUTBOX_RECORD_SIZE, OUTBOX_SECTOR_SIZE);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    sectors_erased++;
+
+    if (lost > 0)
+    {
+        ESP_LOGW(TAG, "Outbox full, %lu unsent records overwritten", (unsigned long)lost);
+        records_lost += lost;
+        pending -= lost;
+    }
+    // Najstariji preostali zapis je na početku sljedećeg sektora
+    if (tail_index >= first_index && tail_index < first_index + RECORDS_PER_SECTOR)
+    {
+        tail_index = pending > 0 ? (first_index + RECORDS_PER_SECTOR) % record_count : first_index;
+    }
+    return ESP_OK;
+}
+
+esp_err_t outbox_init(void)
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)OUTBOX_PARTITION_SUBTYPE,
+                                         OUTBOX_PARTITION_LABEL);
+    if (partition == NULL)
+    {
+        ESP_LOGE(TAG, "No '%s' partition in the partition table", OUTBOX_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    record_count = (partition->size / OUTBOX_SECTOR_SIZE) * RECORDS_PER_SECTOR;
+    if (record_count < 2 * RECORDS_PER_SECTOR)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Pronađi zadnji upisani zapis i najstariji neposlani
+    outbox_record_t record;
+    bool found = false;
+    bool found_pending = false;
+    uint32_t last_seq = 0;
+    uint32_t oldest_pending_seq = 0;
+
+    for (uint32_t i = 0; i < record_count; i++)
+    {
+        if (!read_record(i, &record))
+        {
+            continue;
+        }
+        if (!found || (int32_t)(record.seq - last_seq) > 0)
+        {
+            found = true;
+            last_seq = record.seq;
+            write_index = (i + 1) % record_count;
+        }
+        if (is_pending(&record))
+        {
+            pending++;
+            if (!found_pending || (int32_t)(record.seq - oldest_pending_seq) < 0)
+            {
+                found_pending = true;
+                oldest_pending_seq = record.seq;
+                tail_index = i;
+            }
+        }
+    }
+    next_seq = found ? last_seq + 1 : 0;
+    boot_seq = next_seq;
+
+    // Preskoči mjesta iza zadnjeg zapisa koja nisu prazna (npr. upis prekinut resetom)
+    while (write_index % RECORDS_PER_SECTOR != 0)
+    {
+        uint32_t seq = BLANK;
+        esp_partition_read(partition, write_index * OUTBOX_RECORD_SIZE, &seq, sizeof(seq));
+        if (seq == BLANK)
+        {
+            break;
+        }
+        write_index = (write_index + 1) % record_count;
+    }
+    if (pending == 0)
+    {
+        tail_index = write_index;
+    }
+
+    ESP_LOGI(TAG, "%lu records, %lu unsent from before reboot", (unsigned long)record_count, (unsigned long)pending);
+    return ESP_OK;
+}
+
+void outbox_append(const void *payload, size_t length)
+{
+    if (buffered == OUTBOX_WRITE_BATCH)
+    {
+        outbox_flush();
+    }
+    if (length > OUTBOX_PAYLOAD_SIZE)
+    {
+        length = OUTBOX_PAYLOAD_SIZE;
+    }
+
+    outbox_record_t *record = &buffer[buffered++];
+    memset(record, 0xFF, sizeof(*record));
+    record->seq = next_seq++;
+    if (next_seq == BLANK)
+    {
+        next_seq = 0;
+    }
+    record->length = (uint16_t)length;
+    memcpy(record->payload, payload, length);
+    record->crc = record_crc(record);
+}
+
+esp_err_t outbox_flush(void)
+{
+    int written = 0;
+
+    while (written < buffered)
+    {
+        if (write_index % RECORDS_PER_SECTOR == 0)
+        {
+            esp_err_t err = erase_sector(write_index);
+            if (err != ESP_OK)
+            {
+                return err;
+            }
+        }
+
+        // Jedan upis za sve zapise do kraja sektora
+        int run = RECORDS_PER_SECTOR - write_index % RECORDS_PER_SECTOR;
+        if (run > buffered - written)
+        {
+            run = buffered - written;
+        }
+        esp_err_t err = esp_partition_write(partition, write_index * OUTBOX_RECORD_SIZE, &buffer[written],
+                                            run * OUTBOX_RECORD_SIZE);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Write failed: %s", esp_err_to_name(err));
+            return err;
+        }
+
+        if (pending == 0)
+        {
+            tail_index = write_index;
+        }
+        write_index = (write_index + run) % record_count;
+        pending += run;
+        records_written += run;
+        written += run;
+    }
+
+    buffered = 0;
+    return ESP_OK;
+}
+
+uint32_t outbox_pending(void)
+{
+    return pending;
+}
+
+void outbox_cursor_begin(outbox_cursor_t *cursor)
+{
+    cursor->index = tail_index;
+    cursor->count = 0;
+    cursor->this_boot = false;
+}
+
+bool outbox_next(outbox_cursor_t *cursor, void *payload, size_t *length)
+{
+    outbox_record_t record;
+
+    while (cursor->count < pending && cursor->index != write_index)
+    {
+        uint32_t index = cursor->index;
+        cursor->index = (cursor->index + 1) % record_count;
+        if (read_record(index, &record) && is_pending(&record))
+        {
+            memcpy(payload, record.payload, record.length);
+            *length = record.length;
+            cursor->count++;
+            cursor->this_boot = (int32_t)(record.seq - boot_seq) >= 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void outbox_consume(const outbox_cursor_t *cursor)
+{
+    outbox_record_t record;
+    const uint32_t consumed = 0;
+
+    for (uint32_t index = tail_index; index != cursor->index; index = (index + 1) % record_count)
+    {
+        if (read_record(index, &record) && is_pending(&record))
+        {
+            esp_partition_write(partition, index * OUTBOX_RECORD_SIZE + offsetof(outbox_record_t, consumed),
+                                &consumed, sizeof(consumed));
+            pending--;
+        }
+    }
+    tail_index = pending > 0 ? cursor->index : write_index;
+}
+
+void outbox_log_stats(void)
+{
+    ESP_LOGI(TAG, "%lu unsent, %lu written, %lu sectors erased, %lu lost to overflow",
+             (unsigned long)pending, (unsigned long)records_written, (unsigned long)sectors_erased,
+             (unsigned long)records_lost);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Jedan zapis u flash-u: 16 bajta zaglavlja + sadržaj
+#define OUTBOX_RECORD_SIZE 32
+#define OUTBOX_PAYLOAD_SIZE (OUTBOX_RECORD_SIZE - 16)
+
+// Koliko zapisa se skupi u RAM-u prije jednog upisa u flash
+#define OUTBOX_WRITE_BATCH 8
+
+// Pozicija čitanja od najstarijeg neposlanog zapisa
+typedef struct
+{
+    uint32_t index; // Sljedeći zapis za čitanje
+    uint32_t count; // Pročitanih neposlanih zapisa
+    bool this_boot; // Zadnji pročitani zapis je upisan poslije outbox_init()
+} outbox_cursor_t;
+
+/**
+ * @brief Pronađi particiju "outbox" i vrati stanje iz prethodnog rada
+ *
+ * Zapisi koji nisu označeni kao poslani ostaju na čekanju i poslije reseta.
+ */
+esp_err_t outbox_init(void);
+
+/**
+ * @brief Dodaj zapis (upisuje se u flash tek pri outbox_flush() ili kad se skupi OUTBOX_WRITE_BATCH)
+ *
+ * Sadržaj duži od OUTBOX_PAYLOAD_SIZE se skraćuje. Ako je prsten pun,
+ * najstariji neposlani zapisi se gube.
+ */
+void outbox_append(const void *payload, size_t length);
+
+/**
+ * @brief Upiši sve skupljene zapise u flash
+ */
+esp_err_t outbox_flush(void);
+
+/**
+ * @return Broj zapisa u flash-u koji još nisu poslani
+ */
+uint32_t outbox_pending(void);
+
+/**
+ * @brief Počni čitanje od najstarijeg neposlanog zapisa
+ */
+void outbox_cursor_begin(outbox_cursor_t *cursor);
+
+/**
+ * @brief Pročitaj sljedeći neposlani zapis
+ *
+ * @param payload Bafer od najmanje OUTBOX_PAYLOAD_SIZE bajta
+ * @return false ako nema više zapisa
+ */
+bool outbox_next(outbox_cursor_t *cursor, void *payload, size_t *length);
+
+/**
+ * @brief Označi kao poslane sve zapise do pozicije cursor-a
+ */
+void outbox_consume(const outbox_cursor_t *cursor);
+
+/**
+ * @brief Ispiši broj zapisa na čekanju i izgubljenih zapisa
+ */
+void outbox_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "power.h"
+
+static const char *TAG = "power";
+
+// Drži se dok igra traje; bez nje CPU ulazi u light sleep čim je besposlen
+static esp_pm_lock_handle_t game_lock = NULL;
+static volatile bool active = false;
+
+// Zadnja ivica tipke koja je stigla dok je uređaj mirovao (0 = nema)
+static volatile int64_t idle_edge_us = 0;
+
+void power_init(uint64_t wakeup_pins)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true,
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "game", &game_lock));
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is not set, device will not sleep while idle");
+#endif
+
+    // Pritisak spušta pin na 0, pa budi na nizak nivo
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+    {
+        if (wakeup_pins & (1ULL << pin))
+        {
+            ESP_ERROR_CHECK(gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL));
+        }
+    }
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+}
+
+void power_set_active(bool want_active)
+{
+    if (want_active == active)
+    {
+        return;
+    }
+
+    if (game_lock != NULL)
+    {
+        if (want_active)
+        {
+            esp_pm_lock_acquire(game_lock);
+        }
+        else
+        {
+            esp_pm_lock_release(game_lock);
+        }
+    }
+    active = want_active;
+}
+
+bool power_is_active(void)
+{
+    return active;
+}
+
+void power_note_edge(int64_t edge_us)
+{
+    if (!active)
+    {
+        idle_edge_us = edge_us;
+    }
+}
+
+void power_log_wake_latency(void)
+{
+    int64_t edge_us = idle_edge_us;
+    if (edge_us == 0)
+    {
+        return;
+    }
+    idle_edge_us = 0;
+
+    int64_t latency_us = esp_timer_get_time() - edge_us;
+    if (latency_us > WAKE_TO_FRAME_BUDGET_MS * 1000LL)
+    {
+        ESP_LOGW(TAG, "Wake to first frame took %lld us (budget %d ms)", latency_us, WAKE_TO_FRAME_BUDGET_MS);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Wake to first frame: %lld us", latency_us);
+    }
+}
+
+void power_log_stats(void)
+{
+#if CONFIG_PM_PROFILING
+    // Udio vremena u light sleep režimu je osnova za procjenu potrošnje u mirovanju
+    esp_pm_dump_locks(stdout);
+#endif
+}
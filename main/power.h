@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Najveće dozvoljeno kašnjenje od buđenja do prvog LED frejma
+#define WAKE_TO_FRAME_BUDGET_MS 50
+
+/**
+ * @brief Uključi automatski light sleep i buđenje preko tipki
+ *
+ * Tipke moraju već biti konfigurisane kao ulazi sa pull-up otpornikom.
+ * Buđenje radi na nivo, pa se prekid tipki mora prebacivati između
+ * GPIO_INTR_LOW_LEVEL i GPIO_INTR_HIGH_LEVEL u ISR-u.
+ *
+ * @param wakeup_pins Maska pinova tipki
+ */
+void power_init(uint64_t wakeup_pins);
+
+/**
+ * @brief Zabrani (true) ili dozvoli (false) light sleep
+ *
+ * Dok igra traje, LED traka, displej i sat igre moraju raditi bez prekida.
+ */
+void power_set_active(bool active);
+
+/**
+ * @return true ako je light sleep trenutno zabranjen
+ */
+bool power_is_active(void);
+
+/**
+ * @brief Zapamti vrijeme ivice tipke (iz ulaznog zadatka) ako je stigla dok uređaj miruje
+ */
+void power_note_edge(int64_t edge_us);
+
+/**
+ * @brief Izmjeri kašnjenje od zadnje ivice u mirovanju do sada
+ *
+ * Poziva se kad je prvi frejm nakon buđenja poslan. Ispisuje upozorenje
+ * ako je budžet WAKE_TO_FRAME_BUDGET_MS prekoračen.
+ */
+void power_log_wake_latency(void);
+
+/**
+ * @brief Ispiši koliko je vremena uređaj proveo u kojem režimu napajanja
+ */
+void power_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "game_bus.h"
+#include "game_state.h"
+#include "spectator.h"
+
+static const char *TAG = "spectator";
+
+// Sesije: gledaoci i još dvije za obične zahtjeve (/state)
+#define SPECTATOR_MAX_SESSIONS (SPECTATOR_MAX_CLIENTS + 2)
+
+// Spor gledalac ne smije dugo kočiti objavu ostalima
+#define SPECTATOR_SEND_TIMEOUT_S 1
+
+// Gledaoci dobiju stanje i kad se ništa ne mijenja, da vide da je veza živa
+#define SPECTATOR_REFRESH_MS 1000
+
+#define SPECTATOR_JSON_SIZE 160
+#define SPECTATOR_FRAME_MAX_SIZE (SPECTATOR_FRAME_HEADER_SIZE + 2 * MAX_TEAMS)
+
+static const char sse_headers[] = "HTTP/1.1 200 OK\r\n"
+                                  "Content-Type: text/event-stream\r\n"
+                                  "Cache-Control: no-cache\r\n"
+                                  "Connection: keep-alive\r\n"
+                                  "Access-Control-Allow-Origin: *\r\n"
+                                  "\r\n";
+
+static const char *state_names[] = {
+    [GAME_OFF] = "off",
+    [GAME_PLAYING] = "playing",
+    [GAME_FINISHED] = "finished",
+};
+
+typedef struct
+{
+    int fd;
+    bool websocket; // Binarni okviri preko WebSocket-a, inače SSE
+} spectator_client_t;
+
+static httpd_handle_t server = NULL;
+static int game_time_seconds = 0;
+
+// Gledaoci; mijenja ih i čita samo zadatak HTTP servera
+static spectator_client_t clients[SPECTATOR_MAX_CLIENTS];
+static int client_count = 0;
+
+// Objava je već u redu HTTP servera, nova promjena je ne mora ponovo slati
+static bool broadcast_queued = false;
+
+// Statistika
+static uint32_t broadcasts = 0;
+static uint32_t sends = 0;
+static uint32_t send_failures = 0;
+static uint32_t rejected = 0;
+static int max_clients = 0;
+static uint32_t max_broadcast_us = 0; // Najduža objava svim gledaocima, od zadnjeg ispisa
+static uint64_t broadcast_total_us = 0;
+
+// Napravi JSON stanja; vraća dužinu ili -1 ako ne stane
+static int format_json(const game_snapshot_t *game, uint32_t generation, char *buffer, size_t size)
+{
+    int remaining_s = game->state == GAME_PLAYING ? game_time_seconds - game->current_game_time : 0;
+    int length = snprintf(buffer, size,
+                          "{\"gen\":%lu,\"state\":\"%s\",\"team\":\"%s\",\"hold\":\"%s\",\"elapsed_s\":%d,\"remaining_s\":%d}",
+                          (unsigned long)generation, state_names[game->state], team_name(game->team),
+                          team_name(game->hold_team), game->current_game_time, remaining_s);
+    return length < size ? length : -1;
+}
+
+// Napravi SSE okvir ("data: <json>\n\n")
+static int format_event(const game_snapshot_t *game, uint32_t generation, char *buffer, size_t size)
+{
+    static const char prefix[] = "data: ";
+    const size_t prefix_length = sizeof(prefix) - 1;
+
+    memcpy(buffer, prefix, prefix_length);
+    int length = format_json(game, generation, buffer + prefix_length, size - prefix_length - 2);
+    if (length < 0)
+    {
+        return -1;
+    }
+    length += prefix_length;
+    buffer[length++] = '\n';
+    buffer[length++] = '\n';
+    return length;
+}
+
+static void put_u16(uint8_t *out, uint16_t value)
+{
+    out[0] = value & 0xff;
+    out[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *out, uint32_t value)
+{
+    put_u16(out, value & 0xffff);
+    put_u16(out + 2, value >> 16);
+}
+
+// Napravi binarni okvir (format je opisan u spectator.h); vraća dužinu
+static size_t format_frame(const game_snapshot_t *game, uint8_t *frame)
+{
+    uint32_t remaining_ms = 0;
+    if (game->state == GAME_PLAYING)
+    {
+        // Sat igre ide u sekundama, milisekunde se računaju od zadnjeg pomaka
+        int64_t since_tick_ms = (esp_timer_get_time() - game->tick_us) / 1000;
+        remaining_ms = (game_time_seconds - game->current_game_time) * 1000;
+        if (since_tick_ms > 0)
+        {
+            remaining_ms -= since_tick_ms < 999 ? since_tick_ms : 999;
+        }
+    }
+
+    frame[0] = SPECTATOR_FRAME_VERSION;
+    frame[1] = game->state;
+    frame[2] = (uint8_t)game->team;
+    frame[3] = (uint8_t)game->hold_team;
+    put_u32(frame + 4, remaining_ms);
+    for (int i = 0; i < team_count; i++)
+    {
+        put_u16(frame + SPECTATOR_FRAME_HEADER_SIZE + 2 * i, game->hold_seconds[i]);
+    }
+    return SPECTATOR_FRAME_HEADER_SIZE + 2 * team_count;
+}
+
+static void add_client(int fd, bool websocket)
+{
+    clients[client_count++] = (spectator_client_t){.fd = fd, .websocket = websocket};
+    if (client_count > max_clients)
+    {
+        max_clients = client_count;
+    }
+    ESP_LOGI(TAG, "%s spectator %d connected, %d watching", websocket ? "WebSocket" : "SSE", fd, client_count);
+}
+
+static void remove_client(int fd)
+{
+    for (int i = 0; i < client_count; i++)
+    {
+        if (clients[i].fd == fd)
+        {
+            clients[i] = clients[--client_count];
+            return;
+        }
+    }
+}
+
+// Radi u zadatku HTTP servera: jedno čitanje stanja i po jedno kodiranje za SSE i
+// WebSocket, pa isti bajtovi svim gledaocima
+static void broadcast_work(void *arg)
+{
+    static char event[SPECTATOR_JSON_SIZE + 8];
+    static uint8_t frame[SPECTATOR_FRAME_MAX_SIZE];
+    int event_length = -1;
+    size_t frame_length = 0;
+    game_snapshot_t game;
+
+    // Promjena koja stigne za vrijeme slanja zakazuje novu objavu
+    __atomic_store_n(&broadcast_queued, false, __ATOMIC_RELEASE);
+    if (client_count == 0)
+    {
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    uint32_t generation = game_state_read(&game);
+    broadcasts++;
+
+    for (int i = client_count - 1; i >= 0; i--)
+    {
+        int fd = clients[i].fd;
+        bool sent;
+        if (clients[i].websocket)
+        {
+            if (frame_length == 0)
+            {
+                frame_length = format_frame(&game, frame);
+            }
+            httpd_ws_frame_t ws_frame = {
+                .final = true,
+                .type = HTTPD_WS_TYPE_BINARY,
+                .payload = frame,
+                .len = frame_length,
+            };
+            // Šalje odmah, payload se ne kopira
+            sent = httpd_ws_send_frame_async(server, fd, &ws_frame) == ESP_OK;
+        }
+        else
+        {
+            if (event_length < 0)
+            {
+                event_length = format_event(&game, generation, event, sizeof(event));
+            }
+            sent = event_length > 0 && httpd_socket_send(server, fd, event, event_length, 0) == event_length;
+        }
+
+        if (sent)
+        {
+            sends++;
+            continue;
+        }
+        // Gledalac je otišao ili ne stiže čitati; server zatvara socket i poziva close_client()
+        send_failures++;
+        remove_client(fd);
+        httpd_sess_trigger_close(server, fd);
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    broadcast_total_us += elapsed_us;
+    if (elapsed_us > max_broadcast_us)
+    {
+        max_broadcast_us = elapsed_us;
+    }
+}
+
+static esp_err_t state_handler(httpd_req_t *req)
+{
+    char json[SPECTATOR_JSON_SIZE];
+    game_snapshot_t game;
+    uint32_t generation = game_state_read(&game);
+
+    int length = format_json(&game, generation, json, sizeof(json));
+    if (length < 0)
+    {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    return httpd_resp_send(req, json, length);
+}
+
+static esp_err_t reject_spectator(httpd_req_t *req)
+{
+    rejected++;
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_send(req, "Too many spectators", HTTPD_RESP_USE_STRLEN);
+}
+
+// Pošalji zaglavlja bez dužine tijela i zadrži socket; dalje ga puni broadcast_work()
+static esp_err_t events_handler(httpd_req_t *req)
+{
+    char event[SPECTATOR_JSON_SIZE + 8];
+    game_snapshot_t game;
+
+    if (client_count >= SPECTATOR_MAX_CLIENTS)
+    {
+        return reject_spectator(req);
+    }
+
+    // Novi gledalac odmah dobije trenutno stanje
+    uint32_t generation = game_state_read(&game);
+    int length = format_event(&game, generation, event, sizeof(event));
+    if (httpd_send(req, sse_headers, sizeof(sse_headers) - 1) < 0 || length < 0 ||
+        httpd_send(req, event, length) != length)
+    {
+        return ESP_FAIL;
+    }
+
+    add_client(httpd_req_to_sockfd(req), false);
+    return ESP_OK;
+}
+
+// GET je završeni handshake, sve poslije su okviri od gledaoca (ignorišu se)
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+    {
+        if (client_count >= SPECTATOR_MAX_CLIENTS)
+        {
+            // Handshake je već odgovoren, pa se veza samo zatvara
+            rejected++;
+            return ESP_FAIL;
+        }
+
+        uint8_t frame[SPECTATOR_FRAME_MAX_SIZE];
+        game_snapshot_t game;
+        game_state_read(&game);
+        httpd_ws_frame_t ws_frame = {
+            .final = true,
+            .type = HTTPD_WS_TYPE_BINARY,
+            .payload = frame,
+            .len = format_frame(&game, frame),
+        };
+        int fd = httpd_req_to_sockfd(req);
+        if (httpd_ws_send_frame_async(server, fd, &ws_frame) != ESP_OK)
+        {
+            return ESP_FAIL;
+        }
+        add_client(fd, true);
+        return ESP_OK;
+    }
+
+    // Gledalac ništa ne treba slati; pročitaj kratke okvire da ne ostanu u socketu
+    uint8_t payload[32];
+    httpd_ws_frame_t ws_frame = {0};
+    if (httpd_ws_recv_frame(req, &ws_frame, 0) != ESP_OK || ws_frame.len > sizeof(payload))
+    {
+        return ESP_FAIL;
+    }
+    ws_frame.payload = payload;
+    return ws_frame.len > 0 ? httpd_ws_recv_frame(req, &ws_frame, ws_frame.len) : ESP_OK;
+}
+
+// Server zatvara sesiju (gledalac otišao ili slanje nije uspjelo)
+static void close_client(httpd_handle_t handle, int fd)
+{
+    remove_client(fd);
+    close(fd);
+}
+
+// Prati promjene stanja i zakazuje objavu u zadatku HTTP servera
+static void spectator_task(void *arg)
+{
+    game_bus_sub_t *sub = game_bus_subscribe("spectate", GAME_EVT_START | GAME_EVT_CAPTURE | GAME_EVT_TICK |
+                                                             GAME_EVT_FINISH | GAME_EVT_RESET | GAME_EVT_HOLD);
+
+    while (1)
+    {
+        // Bez promjene (npr. dok igra miruje) gledaoci ipak dobiju stanje svake sekunde
+        game_bus_wait(sub, pdMS_TO_TICKS(SPECTATOR_REFRESH_MS));
+        if (__atomic_load_n(&client_count, __ATOMIC_RELAXED) == 0 ||
+            __atomic_exchange_n(&broadcast_queued, true, __ATOMIC_ACQ_REL))
+        {
+            continue;
+        }
+        if (httpd_queue_work(server, broadcast_work, NULL) != ESP_OK)
+        {
+            __atomic_store_n(&broadcast_queued, false, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+esp_err_t spectator_start(int game_seconds, BaseType_t core, UBaseType_t priority)
+{
+    game_time_seconds = game_seconds;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.core_id = core;
+    config.max_open_sockets = SPECTATOR_MAX_SESSIONS;
+    config.send_wait_timeout = SPECTATOR_SEND_TIMEOUT_S;
+    config.close_fn = close_client;
+
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const httpd_uri_t state_uri = {
+        .uri = "/state",
+        .method = HTTP_GET,
+        .handler = state_handler,
+    };
+    const httpd_uri_t events_uri = {
+        .uri = "/events",
+        .method = HTTP_GET,
+        .handler = events_handler,
+    };
+    const httpd_uri_t ws_uri = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .is_websocket = true,
+    };
+    httpd_register_uri_handler(server, &state_uri);
+    httpd_register_uri_handler(server, &events_uri);
+    httpd_register_uri_handler(server, &ws_uri);
+
+    xTaskCreatePinnedToCore(spectator_task, "spectator", 2048, NULL, priority, NULL, core);
+    return ESP_OK;
+}
+
+void spectator_log_stats(void)
+{
+    int websockets = 0;
+    for (int i = 0; i < client_count; i++)
+    {
+        websockets += clients[i].websocket;
+    }
+
+    ESP_LOGI(TAG, "%d spectators (%d WebSocket, max %d, %lu rejected), %lu broadcasts, %lu sends, %lu failed",
+             client_count, websockets, max_clients, (unsigned long)rejected, (unsigned long)broadcasts,
+             (unsigned long)sends, (unsigned long)send_failures);
+    ESP_LOGI(TAG, "Broadcast avg %lu us, max %lu us, free heap %lu B (min %lu B)",
+             (unsigned long)(broadcasts ? broadcast_total_us / broadcasts : 0), (unsigned long)max_broadcast_us,
+             (unsigned long)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+             (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    max_broadcast_us = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Najviše gledalaca istovremeno, SSE i WebSocket zajedno (svaki drži jedan socket otvoren)
+#define SPECTATOR_MAX_CLIENTS 12
+
+/*
+ * Binarni WebSocket okvir, svi brojevi little-endian:
+ *   0     verzija (SPECTATOR_FRAME_VERSION)
+ *   1     GameState
+ *   2     tim koji drži brdo (int8, -1 = nijedan)
+ *   3     tim koji drži tipku (int8, -1 = nijedan)
+ *   4..7  preostalo vrijeme igre u ms (uint32)
+ *   8..   ukupno držanje brda po timu u sekundama (uint16 za svaki tim iz tabele)
+ * Sa dva tima okvir ima 12 bajtova, sa četiri 16.
+ */
+#define SPECTATOR_FRAME_VERSION 1
+#define SPECTATOR_FRAME_HEADER_SIZE 8
+
+/**
+ * @brief Pokreni HTTP server za gledaoce
+ *
+ * GET /state vraća trenutno stanje igre kao JSON, GET /events je
+ * Server-Sent Events tok koji šalje isti JSON, a /ws je WebSocket koji
+ * šalje binarni okvir. Tokovi dobiju stanje na svaku promjenu i barem
+ * jednom u sekundi. Stanje se kodira jednom po objavi, bez obzira na
+ * broj gledalaca.
+ *
+ * @param game_seconds Trajanje igre, za preostalo vrijeme
+ * @param core Jezgra zadatka koji prati promjene stanja
+ * @param priority Prioritet tog zadatka
+ */
+esp_err_t spectator_start(int game_seconds, BaseType_t core, UBaseType_t priority);
+
+/**
+ * @brief Ispiši broj gledalaca, objava, trajanje objave i slobodan heap
+ */
+void spectator_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
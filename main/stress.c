@@ -0,0 +1,162 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "button_input.h"
+#include "notify_queue.h"
+#include "stress.h"
+#include "task_stats.h"
+#include "teams.h"
+
+static const char *TAG = "stress";
+
+#define STRESS_TIMER_RESOLUTION_HZ 1000000
+
+static gptimer_handle_t timer = NULL;
+
+// Kopija pinova u RAM-u, da ISR ne čita tabelu timova
+static int pins[MAX_TEAMS];
+static int pin_count = 0;
+
+// Stanje i statistika jednog testa (piše samo ISR tajmera dok test traje)
+static uint32_t edge_index = 0;
+static uint8_t edge_flags = 0;
+static bool running = false; // Konzola ne smije pokrenuti dva testa istovremeno
+
+static bool IRAM_ATTR stress_on_alarm(gptimer_handle_t alarm_timer, const gptimer_alarm_event_data_t *data, void *arg)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    // Parna ivica je pritisak (0), neparna otpuštanje (1), pa sljedeći tim
+    int pin = pins[(edge_index / 2) % pin_count];
+    button_input_inject_from_isr(pin, edge_index & 1, edge_flags, &higher_priority_task_woken);
+    edge_index++;
+    return higher_priority_task_woken == pdTRUE;
+}
+
+esp_err_t stress_init(void)
+{
+    if (button_input_core() != xPortGetCoreID())
+    {
+        ESP_LOGE(TAG, "Must be initialised on the button ISR core");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    pin_count = team_count;
+    for (int i = 0; i < team_count; i++)
+    {
+        pins[i] = teams[i].pin;
+    }
+
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = STRESS_TIMER_RESOLUTION_HZ,
+        // Najniži nivo, da tajmer nikad ne prekine ISR tipki usred pisanja u prsten
+        .intr_priority = 1,
+    };
+    esp_err_t err = gptimer_new_timer(&timer_config, &timer);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = stress_on_alarm,
+    };
+    return gptimer_register_event_callbacks(timer, &callbacks, NULL);
+}
+
+// Pokreni tajmer, sačekaj trajanje testa i zaustavi ga; greške se vraćaju konzoli
+static esp_err_t inject_for(uint32_t duration_s)
+{
+    esp_err_t err = gptimer_enable(timer);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = gptimer_start(timer);
+    if (err == ESP_OK)
+    {
+        vTaskDelay(pdMS_TO_TICKS(duration_s * 1000));
+        err = gptimer_stop(timer);
+    }
+    esp_err_t disable_err = gptimer_disable(timer);
+    return err != ESP_OK ? err : disable_err;
+}
+
+esp_err_t stress_run(uint32_t captures_per_second, uint32_t duration_s, bool direct)
+{
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (captures_per_second == 0 || captures_per_second > STRESS_MAX_RATE || duration_s == 0 ||
+        duration_s > STRESS_MAX_DURATION_S)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (__atomic_exchange_n(&running, true, __ATOMIC_ACQUIRE))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Dvije ivice po zauzimanju
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = STRESS_TIMER_RESOLUTION_HZ / (2 * captures_per_second),
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    esp_err_t err = gptimer_set_alarm_action(timer, &alarm_config);
+    if (err == ESP_OK)
+    {
+        err = gptimer_set_raw_count(timer, 0);
+    }
+    if (err != ESP_OK)
+    {
+        __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+        return err;
+    }
+
+    button_input_stats_t before, after;
+    notify_queue_stats_t queue_before, queue_after;
+    button_input_clear_high_water();
+    button_input_get_stats(&before);
+    notify_queue_clear_high_water();
+    notify_queue_get_stats(&queue_before);
+    edge_index = 0;
+    edge_flags = direct ? BUTTON_EDGE_DIRECT : 0;
+
+    ESP_LOGI(TAG, "Injecting %lu captures/s for %lu s (%s)", (unsigned long)captures_per_second,
+             (unsigned long)duration_s, direct ? "direct, past debounce and cooldown" : "through debounce");
+    task_stats_log(); // Početak perioda, izvještaj na kraju pokriva samo test
+
+    err = inject_for(duration_s);
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Stress timer failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Pusti zadatak za tipke da isprazni prsten prije mjerenja
+    vTaskDelay(pdMS_TO_TICKS(100));
+    button_input_get_stats(&after);
+    notify_queue_get_stats(&queue_after);
+
+    ESP_LOGI(TAG, "CPU share during the run (idle tasks show the headroom per core):");
+    task_stats_log();
+    ESP_LOGI(TAG, "%lu edges injected, %lu dropped (ring full), ring high-water %lu/%d, %lu presses accepted",
+             (unsigned long)(after.injected - before.injected), (unsigned long)(after.dropped - before.dropped),
+             (unsigned long)after.ring_high_water, BUTTON_RING_SIZE,
+             (unsigned long)(after.accepted_presses - before.accepted_presses));
+    ESP_LOGI(TAG, "Network queue high-water %lu/%d, %lu collapsed, %lu evicted, %lu dropped (%lu critical)",
+             (unsigned long)queue_after.high_water, NOTIFY_QUEUE_SIZE + NOTIFY_QUEUE_RESERVE,
+             (unsigned long)(queue_after.collapsed - queue_before.collapsed),
+             (unsigned long)(queue_after.evicted - queue_before.evicted),
+             (unsigned long)(queue_after.dropped - queue_before.dropped),
+             (unsigned long)(queue_after.dropped_critical - queue_before.dropped_critical));
+    return ESP_OK;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Najveća brzina ubacivanja (zauzimanja brda u sekundi, svako je pritisak + otpuštanje)
+#define STRESS_MAX_RATE 5000
+#define STRESS_MAX_DURATION_S 600
+
+/**
+ * @brief Pripremi tajmer za sintetičke ivice tipki
+ *
+ * Mora se pozvati nakon button_input_start() i sa iste jezgre, jer se
+ * prekid tajmera instalira na jezgri koja ovo pozove.
+ */
+esp_err_t stress_init(void);
+
+/**
+ * @brief Ubacuj zauzimanja brda zadanom brzinom i ispiši izvještaj
+ *
+ * Tajmer naizmjenično ubacuje pritisak i otpuštanje tipke, tim po tim, u
+ * isti prsten koji puni ISR tipki. Blokira za vrijeme trajanja testa.
+ *
+ * Bez direct ivice prolaze debounce (20 ms) i cooldown zauzimanja (1 s)
+ * kao prave tipke, pa se pri velikoj brzini skoro sve odbace i test
+ * opterećuje samo ISR, prsten i zadatak za tipke. Sa direct svaki par
+ * ivica je pravo zauzimanje: upis stanja, game_bus, traka, displej i
+ * gledaoci rade punom brzinom. Poruke o zauzimanjima se i tada spajaju u
+ * jednu po prozoru od 3 s, pa red poruka dobije najviše jednu.
+ *
+ * @return ESP_ERR_INVALID_ARG za brzinu ili trajanje van granica,
+ *         ESP_ERR_INVALID_STATE ako stress_init() nije uspio ili test već traje,
+ *         ili grešku tajmera
+ */
+esp_err_t stress_run(uint32_t captures_per_second, uint32_t duration_s, bool direct);
+
+#ifdef __cplusplus
+}
+#endif
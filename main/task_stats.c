@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "task_stats.h"
+
+static const char *TAG = "task_stats";
+
+#define TASK_STATS_MAX_TASKS 32
+
+// Brojači iz prethodnog poziva, da se računa udio samo za zadnji period
+typedef struct
+{
+    UBaseType_t task_number;
+    configRUN_TIME_COUNTER_TYPE run_time;
+} previous_run_time_t;
+
+static previous_run_time_t previous[TASK_STATS_MAX_TASKS];
+static UBaseType_t previous_count = 0;
+static configRUN_TIME_COUNTER_TYPE previous_total = 0;
+
+static configRUN_TIME_COUNTER_TYPE previous_run_time_of(UBaseType_t task_number)
+{
+    for (UBaseType_t i = 0; i < previous_count; i++)
+    {
+        if (previous[i].task_number == task_number)
+        {
+            return previous[i].run_time;
+        }
+    }
+    return 0;
+}
+
+void task_stats_log(void)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 2; // Rezerva ako se zadatak napravi u međuvremenu
+    TaskStatus_t *tasks = malloc(capacity * sizeof(TaskStatus_t));
+    if (tasks == NULL)
+    {
+        ESP_LOGE(TAG, "Not enough memory for task stats");
+        return;
+    }
+
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, capacity, &total);
+    configRUN_TIME_COUNTER_TYPE elapsed = total - previous_total;
+
+    if (elapsed > 0)
+    {
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            configRUN_TIME_COUNTER_TYPE used = tasks[i].ulRunTimeCounter - previous_run_time_of(tasks[i].xTaskNumber);
+            uint32_t permille = (uint32_t)((uint64_t)used * 1000 / elapsed);
+            ESP_LOGI(TAG, "%-16s prio %2u  %3lu.%lu%% cpu  stack free %lu",
+                     tasks[i].pcTaskName, (unsigned)tasks[i].uxCurrentPriority,
+                     (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+                     (unsigned long)tasks[i].usStackHighWaterMark);
+        }
+    }
+
+    previous_count = count < TASK_STATS_MAX_TASKS ? count : TASK_STATS_MAX_TASKS;
+    for (UBaseType_t i = 0; i < previous_count; i++)
+    {
+        previous[i].task_number = tasks[i].xTaskNumber;
+        previous[i].run_time = tasks[i].ulRunTimeCounter;
+    }
+    previous_total = total;
+    free(tasks);
+#else
+    ESP_LOGW(TAG, "Run time stats are disabled in sdkconfig");
+#endif
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ispiši udio CPU vremena svakog zadatka od zadnjeg poziva
+ *
+ * Udio je u procentima jedne jezgre, pa zbir za obje jezgre ide do 200%.
+ * Traži CONFIG_FREERTOS_USE_TRACE_FACILITY i
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ */
+void task_stats_log(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+#include <string.h>
+#include "driver/gpio.h"
+#include "teams.h"
+
+// Tabela timova - za igru sa tri ili četiri frakcije dovoljno je dodati red
+const team_t teams[] = {
+    {.pin = 47, .r = 255, .name = "RED"},  // Lijeva tipka
+    {.pin = 21, .b = 255, .name = "BLUE"}, // Desna tipka
+};
+const int team_count = sizeof(teams) / sizeof(teams[0]);
+
+_Static_assert(sizeof(teams) / sizeof(teams[0]) <= MAX_TEAMS, "Too many teams, raise MAX_TEAMS");
+
+static team_id_t pin_to_team[GPIO_NUM_MAX];
+
+void teams_init(void)
+{
+    memset(pin_to_team, TEAM_NONE, sizeof(pin_to_team));
+    for (int i = 0; i < team_count; i++)
+    {
+        pin_to_team[teams[i].pin] = (team_id_t)i;
+    }
+}
+
+team_id_t team_from_pin(int pin)
+{
+    if (pin < 0 || pin >= GPIO_NUM_MAX)
+    {
+        return TEAM_NONE;
+    }
+    return pin_to_team[pin];
+}
+
+const char *team_name(team_id_t team)
+{
+    return team == TEAM_NONE ? "NONE" : teams[team].name;
+}
+
+uint64_t teams_button_mask(void)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < team_count; i++)
+    {
+        mask |= 1ULL << teams[i].pin;
+    }
+    return mask;
+}
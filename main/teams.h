@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_TEAMS 8
+#define TEAM_NONE (-1)
+
+// Indeks u tabeli teams[], ili TEAM_NONE
+typedef int8_t team_id_t;
+
+typedef struct
+{
+    int pin;            // GPIO tipke tima (pull-up, pritisak spušta na 0)
+    uint8_t r, g, b, w; // Boja tima na LED traci
+    const char *name;   // Ime tima na displeju i u porukama
+} team_t;
+
+extern const team_t teams[];
+extern const int team_count;
+
+/**
+ * @brief Napravi tabelu za pretragu tima po pinu
+ */
+void teams_init(void);
+
+/**
+ * @return Tim čija je tipka na pinu, ili TEAM_NONE
+ */
+team_id_t team_from_pin(int pin);
+
+/**
+ * @return Ime tima, ili "NONE" za TEAM_NONE
+ */
+const char *team_name(team_id_t team);
+
+/**
+ * @return Maska pinova svih tipki, za gpio_config i buđenje
+ */
+uint64_t teams_button_mask(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,82 @@
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_netif_sntp.h"
+#include "esp_timer.h"
+#include "wallclock.h"
+
+static const char *TAG = "wallclock";
+
+// Za testiranje sa lokalnim serverom: idf.py -DSNTP_SERVER=<ip> build (tools/ntp_standin.py)
+#ifndef SNTP_SERVER
+#define SNTP_SERVER "pool.ntp.org"
+#endif
+
+// UTC = esp_timer + offset; 0 dok nema sinhronizacije
+static int64_t offset_us = 0;
+static portMUX_TYPE offset_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Statistika
+static uint32_t syncs = 0;
+static int64_t last_sync_us = 0;   // esp_timer vrijeme zadnje sinhronizacije
+static int64_t last_step_us = 0;   // Koliko je zadnja sinhronizacija pomjerila UTC
+
+// Poziva ga SNTP nakon što je postavio sistemsko vrijeme
+static void on_time_sync(struct timeval *tv)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t new_offset_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - now;
+
+    portENTER_CRITICAL(&offset_lock);
+    int64_t old_offset_us = offset_us;
+    offset_us = new_offset_us;
+    portEXIT_CRITICAL(&offset_lock);
+
+    syncs++;
+    last_sync_us = now;
+    last_step_us = old_offset_us != 0 ? new_offset_us - old_offset_us : 0;
+    if (old_offset_us == 0)
+    {
+        ESP_LOGI(TAG, "Synced to %s, UTC %lld ms", SNTP_SERVER, (now + new_offset_us) / 1000);
+    }
+}
+
+void wallclock_start(void)
+{
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(SNTP_SERVER);
+    config.sync_cb = on_time_sync;
+
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start SNTP: %s", esp_err_to_name(err));
+    }
+}
+
+bool wallclock_is_synced(void)
+{
+    portENTER_CRITICAL(&offset_lock);
+    bool synced = offset_us != 0;
+    portEXIT_CRITICAL(&offset_lock);
+    return synced;
+}
+
+int64_t wallclock_utc_us(int64_t monotonic_us)
+{
+    portENTER_CRITICAL(&offset_lock);
+    int64_t offset = offset_us;
+    portEXIT_CRITICAL(&offset_lock);
+    return offset != 0 ? monotonic_us + offset : 0;
+}
+
+void wallclock_log_stats(void)
+{
+    if (syncs == 0)
+    {
+        ESP_LOGI(TAG, "Not synced yet (%s)", SNTP_SERVER);
+        return;
+    }
+    ESP_LOGI(TAG, "%lu syncs, last step %lld us, last sync %lld s ago, UTC now %lld ms", (unsigned long)syncs,
+             last_step_us, (esp_timer_get_time() - last_sync_us) / 1000000,
+             wallclock_utc_us(esp_timer_get_time()) / 1000);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pokreni SNTP; prva sinhronizacija stiže kad Wi-Fi dobije IP
+ *
+ * Razlika između esp_timer vremena i UTC-a se čuva posebno, pa korekcije
+ * sata ne diraju sat igre (on i dalje broji po esp_timer-u i tick-ovima).
+ * Poziva se nakon esp_netif_init().
+ */
+void wallclock_start(void);
+
+/**
+ * @return true nakon prve uspješne SNTP sinhronizacije
+ */
+bool wallclock_is_synced(void);
+
+/**
+ * @brief Pretvori esp_timer vrijeme u UTC
+ *
+ * @return Mikrosekunde od 1970-01-01 UTC, ili 0 ako sat još nije sinhronizovan
+ */
+int64_t wallclock_utc_us(int64_t monotonic_us);
+
+/**
+ * @brief Ispiši broj sinhronizacija, zadnju korekciju i starost zadnje sinhronizacije
+ */
+void wallclock_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
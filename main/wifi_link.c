@@ -0,0 +1,258 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "game_bus.h"
+#include "notifier.h"
+#include "wifi_link.h"
+
+static const char *TAG = "wifi_link";
+
+#define WIFI_NVS_NAMESPACE "wifi_link"
+#define WIFI_NVS_KEY "ap"
+
+// Ponovni pokušaji: prvi odmah, pa eksponencijalni odmak sa pola nasumičnog dijela
+#define WIFI_BACKOFF_BASE_MS 250
+#define WIFI_BACKOFF_MAX_MS 30000
+
+// Nakon ovoliko neuspjeha sa zapamćenom tačkom, skeniraj sve kanale
+#define WIFI_CACHE_MAX_FAILURES 2
+
+// Zadnja pristupna tačka na koju se uređaj uspješno povezao
+typedef struct
+{
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_ap_cache_t;
+
+static wifi_config_t wifi_config;
+static wifi_ap_cache_t cache;
+static bool cache_valid = false;
+static bool cache_in_use = false;
+
+static esp_timer_handle_t retry_timer = NULL;
+static int failed_attempts = 0;
+static volatile bool connected = false;
+
+// Statistika
+static int64_t boot_to_ip_us = 0;       // 0 dok prva IP adresa ne stigne
+static int64_t disconnected_at_us = 0;  // Početak trenutnog prekida
+static uint32_t last_reconnect_ms = 0;
+static uint32_t max_reconnect_ms = 0;
+static uint32_t disconnects = 0;
+static uint32_t connect_attempts = 0;
+static uint8_t last_reason = 0;
+
+static void load_cache(void)
+{
+    nvs_handle_t nvs;
+    size_t length = sizeof(cache);
+
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
+    {
+        return;
+    }
+    cache_valid = nvs_get_blob(nvs, WIFI_NVS_KEY, &cache, &length) == ESP_OK && length == sizeof(cache) &&
+                  cache.channel != 0;
+    nvs_close(nvs);
+}
+
+// Zapamti tačku na koju smo se upravo povezali, ako se promijenila
+static void save_cache(void)
+{
+    wifi_ap_record_t ap_info;
+    nvs_handle_t nvs;
+
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+    {
+        return;
+    }
+    if (cache_valid && cache.channel == ap_info.primary && memcmp(cache.bssid, ap_info.bssid, sizeof(cache.bssid)) == 0)
+    {
+        return;
+    }
+
+    memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+    cache.channel = ap_info.primary;
+    cache_valid = true;
+
+    esp_err_t err = nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(nvs, WIFI_NVS_KEY, &cache, sizeof(cache));
+        if (err == ESP_OK)
+        {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to cache access point: %s", esp_err_to_name(err));
+    }
+}
+
+// Zapamćena tačka preskače skeniranje; bez nje se traži mreža po imenu na svim kanalima
+static void apply_config(bool use_cache)
+{
+    cache_in_use = use_cache && cache_valid;
+    wifi_config.sta.bssid_set = cache_in_use;
+    wifi_config.sta.channel = cache_in_use ? cache.channel : 0;
+    if (cache_in_use)
+    {
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(cache.bssid));
+    }
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+}
+
+static void start_connect(void)
+{
+    connect_attempts++;
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(err));
+    }
+}
+
+static void retry_timer_callback(void *arg)
+{
+    start_connect();
+}
+
+static uint32_t backoff_ms(int attempts)
+{
+    if (attempts <= 1)
+    {
+        return 0;
+    }
+    uint32_t ceiling_ms = WIFI_BACKOFF_MAX_MS;
+    if (attempts < 10)
+    {
+        ceiling_ms = WIFI_BACKOFF_BASE_MS << (attempts - 2);
+    }
+    if (ceiling_ms > WIFI_BACKOFF_MAX_MS)
+    {
+        ceiling_ms = WIFI_BACKOFF_MAX_MS;
+    }
+    return ceiling_ms / 2 + esp_random() % (ceiling_ms / 2 + 1);
+}
+
+static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    {
+        start_connect();
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        game_bus_publish(GAME_EVT_WIFI);
+    }
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+    {
+        int64_t now = esp_timer_get_time();
+        if (boot_to_ip_us == 0)
+        {
+            boot_to_ip_us = now;
+            ESP_LOGI(TAG, "Got IP %lld ms after boot%s", now / 1000, cache_in_use ? " (cached access point)" : "");
+        }
+        else if (disconnected_at_us != 0)
+        {
+            last_reconnect_ms = (uint32_t)((now - disconnected_at_us) / 1000);
+            if (last_reconnect_ms > max_reconnect_ms)
+            {
+                max_reconnect_ms = last_reconnect_ms;
+            }
+            ESP_LOGI(TAG, "Reconnected in %lu ms after %d attempts", (unsigned long)last_reconnect_ms, failed_attempts);
+        }
+        disconnected_at_us = 0;
+        failed_attempts = 0;
+        connected = true;
+        notifier_set_connected(true);
+        save_cache();
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+        const wifi_event_sta_disconnected_t *event = event_data;
+        last_reason = event->reason;
+        if (connected)
+        {
+            disconnects++;
+            disconnected_at_us = esp_timer_get_time();
+        }
+        connected = false;
+        notifier_set_connected(false);
+        game_bus_publish(GAME_EVT_WIFI);
+
+        // Tačka se možda promijenila (drugi ruter, drugi kanal), pa traži mrežu ispočetka
+        failed_attempts++;
+        if (cache_in_use && failed_attempts >= WIFI_CACHE_MAX_FAILURES)
+        {
+            ESP_LOGW(TAG, "Cached access point unreachable, scanning all channels");
+            apply_config(false);
+        }
+
+        uint32_t delay_ms = backoff_ms(failed_attempts);
+        ESP_LOGI(TAG, "Disconnected (reason %d), retry %d in %lu ms", event->reason, failed_attempts,
+                 (unsigned long)delay_ms);
+        if (delay_ms == 0)
+        {
+            start_connect();
+        }
+        else
+        {
+            esp_timer_stop(retry_timer);
+            esp_timer_start_once(retry_timer, delay_ms * 1000ULL);
+        }
+    }
+}
+
+void wifi_link_start(const char *ssid, const char *password)
+{
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    esp_netif_create_default_wifi_sta();
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = retry_timer_callback,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &retry_timer));
+
+    esp_event_handler_instance_t instance_any_id;
+    esp_event_handler_instance_t instance_got_ip;
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
+
+    memset(&wifi_config, 0, sizeof(wifi_config));
+    strlcpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
+    strlcpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password));
+    // Mreža ima lozinku, pa otvorena tačka sa istim imenom nije naša
+    wifi_config.sta.threshold.authmode = password[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+    wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+
+    load_cache();
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    apply_config(true);
+    ESP_ERROR_CHECK(esp_wifi_start());
+}
+
+bool wifi_link_is_connected(void)
+{
+    return connected;
+}
+
+void wifi_link_log_stats(void)
+{
+    ESP_LOGI(TAG, "%s, boot to IP %lld ms, %lu disconnects (last reason %d), reconnect last %lu ms max %lu ms, %lu attempts",
+             connected ? "connected" : "disconnected", boot_to_ip_us / 1000, (unsigned long)disconnects, last_reason,
+             (unsigned long)last_reconnect_ms, (unsigned long)max_reconnect_ms, (unsigned long)connect_attempts);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pokreni Wi-Fi stanicu i automatsko ponovno povezivanje
+ *
+ * Ako je u NVS-u zapamćena zadnja pristupna tačka (BSSID i kanal), prvo
+ * se povezuje direktno na nju bez skeniranja. Nakon svakog prekida
+ * ponovni pokušaji idu sa eksponencijalnim odmakom. Promjene veze se
+ * javljaju notifier-u i preko GAME_EVT_WIFI.
+ *
+ * NVS mora već biti inicijalizovan.
+ */
+void wifi_link_start(const char *ssid, const char *password);
+
+/**
+ * @return true dok stanica ima IP adresu
+ */
+bool wifi_link_is_connected(void);
+
+/**
+ * @brief Ispiši vrijeme od paljenja do IP adrese, trajanje ponovnih povezivanja i prekide
+ */
+void wifi_link_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,343 @@
+// Simulirana brda na Linux-u, preko istog protokola, sinhronizacije sata i UDP prenosa kao firmware.
+// Build:   gcc -O2 -I main -o hill_sim tools/hill_sim.c main/hill_proto.c main/hill_sync.c main/hill_udp.c -lm
+// Brdo:    ./hill_sim member <ime> [sekundi_između_zauzimanja] [drift_ppm] [jitter_us]
+// Tabela:  ./hill_sim aggregator [sekundi_do_zajedničkog_početka]
+// Brdo čeka zajednički početak sa agregatora. Sat brda ide drift_ppm brže od sata računara i
+// kreće sa nasumičnim pomakom; vrijeme prijema beacon-a kasni nasumično do jitter_us. Agregator
+// koristi sat računara, pa brdo može ispisati i stvarnu grešku, ne samo procjenu.
+// Uređaj sa -DHILL_LINK=aggregator -DHILL_TRANSPORT=udp na istoj mreži vidi i simulirana brda.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hill_proto.h"
+#include "hill_sync.h"
+#include "hill_transport.h"
+
+// Kao GameState u main/game_state.h
+enum
+{
+    GAME_OFF,
+    GAME_PLAYING,
+    GAME_FINISHED
+};
+
+#define SIM_TEAMS 4
+#define SIM_GAME_SECONDS 120
+#define SIM_OFFLINE_MS 5000
+#define SIM_SYNC_INTERVAL_MS 500 // Kao HILL_SYNC_INTERVAL_MS u main/hill_link.c
+#define SIM_STATE_MS 1000
+#define SIM_REPORT_MS 5000
+
+static int64_t now_ms(void)
+{
+    return hill_now_us() / 1000;
+}
+
+static const char *state_name(uint8_t state)
+{
+    return state == GAME_PLAYING ? "playing" : state == GAME_FINISHED ? "finished" : "off";
+}
+
+static void sleep_until_us(int64_t real_us)
+{
+    struct timespec until = {
+        .tv_sec = real_us / 1000000,
+        .tv_nsec = (real_us % 1000000) * 1000,
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+}
+
+// Simulirani kristal brda: lokalno = stvarno * (1 + drift) + pomak
+static double drift;
+static int64_t clock_offset_us;
+
+static int64_t local_from_real(int64_t real_us)
+{
+    return real_us + (int64_t)(real_us * drift) + clock_offset_us;
+}
+
+static int64_t real_from_local(int64_t local_us)
+{
+    return (int64_t)((local_us - clock_offset_us) / (1 + drift));
+}
+
+// Greška u stvarnom vremenu ako brdo uradi nešto u lokalno vrijeme local_us umjesto u master_us
+static int64_t true_error_us(int64_t local_us, int64_t master_us)
+{
+    return real_from_local(local_us) - master_us;
+}
+
+// Čeka zajednički početak, pa igra sa nasumičnim zauzimanjima; sekunde igre idu po satu agregatora
+static int run_member(const char *name, int capture_every_s, double drift_ppm, int jitter_us)
+{
+    static hill_sync_t sync;
+    hill_state_t state = {
+        .state = GAME_OFF,
+        .team = -1,
+        .team_count = SIM_TEAMS,
+    };
+    uint8_t frame[HILL_FRAME_MAX];
+    uint16_t handled_start_id = 0;
+    int64_t start_master_us = 0;
+    bool start_pending = false;
+    int tick = 0;
+    int64_t worst_tick_error_us = 0;
+    int64_t next_state_us = 0;
+    int64_t next_report_us = 0;
+
+    drift = drift_ppm * 1e-6;
+    clock_offset_us = (rand() % 10000) * 1000LL;
+    hill_sync_init(&sync);
+    snprintf(state.name, sizeof(state.name), "%s", name);
+    printf("%s: clock %+.1f ppm, offset %lld ms, jitter up to %d us\n", name, drift_ppm,
+           (long long)(clock_offset_us / 1000), jitter_us);
+
+    while (state.state != GAME_FINISHED)
+    {
+        int64_t local_now = local_from_real(hill_now_us());
+
+        // Sljedeći trenutak u kojem brdo nešto radi, u lokalnom vremenu
+        int64_t next_us = next_state_us;
+        int64_t action_us = 0;
+        if (start_pending)
+        {
+            action_us = hill_sync_to_local(&sync.model, start_master_us);
+        }
+        else if (state.state == GAME_PLAYING)
+        {
+            action_us = hill_sync_to_local(&sync.model, start_master_us + (tick + 1) * 1000000LL);
+        }
+        if (action_us != 0 && action_us < next_us)
+        {
+            next_us = action_us;
+        }
+
+        if (action_us != 0 && action_us - local_now < 2000)
+        {
+            // Zadnje dvije milisekunde se spava precizno, kao esp_timer na uređaju
+            sleep_until_us(real_from_local(action_us));
+            if (start_pending)
+            {
+                start_pending = false;
+                state.state = GAME_PLAYING;
+                state.remaining_s = SIM_GAME_SECONDS;
+                memset(state.hold_seconds, 0, sizeof(state.hold_seconds));
+                tick = 0;
+                printf("%s: GAME STARTED, %+lld us from the aggregator's start\n", name,
+                       (long long)true_error_us(action_us, start_master_us));
+            }
+            else
+            {
+                int64_t error_us = true_error_us(action_us, start_master_us + (tick + 1) * 1000000LL);
+                if (llabs(error_us) > llabs(worst_tick_error_us))
+                {
+                    worst_tick_error_us = error_us;
+                }
+                tick++;
+                if (state.team >= 0)
+                {
+                    state.hold_seconds[state.team]++;
+                }
+                if (--state.remaining_s == 0)
+                {
+                    state.state = GAME_FINISHED;
+                }
+                else if (state.remaining_s % capture_every_s == 0)
+                {
+                    state.team = (state.team + 1 + rand() % (SIM_TEAMS - 1)) % SIM_TEAMS;
+                    printf("%s: team %d took the hill, %u s left\n", name, state.team, state.remaining_s);
+                }
+            }
+            next_state_us = 0; // Promjena ide odmah
+            continue;
+        }
+
+        int64_t received_us = 0;
+        int wait_ms = (int)((next_us - local_now) / 1000);
+        if (action_us != 0)
+        {
+            wait_ms -= 2;
+        }
+        wait_ms = wait_ms < 0 ? 0 : wait_ms > 50 ? 50 : wait_ms;
+        int length = hill_udp_transport.receive(frame, sizeof(frame), wait_ms, &received_us);
+
+        hill_beacon_t beacon;
+        if (length > 0 && hill_proto_decode_beacon(frame, length, &beacon))
+        {
+            int64_t jitter = jitter_us > 0 ? rand() % (jitter_us + 1) : 0;
+            hill_sync_beacon(&sync, &beacon, local_from_real(received_us + jitter));
+            if (hill_sync_is_synced(&sync) && beacon.start_id != 0 && beacon.start_id != handled_start_id)
+            {
+                handled_start_id = beacon.start_id;
+                start_master_us = beacon.start_us;
+                start_pending = hill_sync_to_local(&sync.model, start_master_us) > local_from_real(hill_now_us());
+                printf("%s: start %u %s\n", name, beacon.start_id, start_pending ? "scheduled" : "arrived too late");
+            }
+        }
+
+        local_now = local_from_real(hill_now_us());
+        if (local_now >= next_state_us)
+        {
+            state.sync_error_us = hill_sync_reported_error_us(&sync);
+            size_t frame_length = hill_proto_encode(&state, frame, sizeof(frame));
+            if (hill_udp_transport.send(frame, frame_length) != 0)
+            {
+                perror("send");
+            }
+            state.seq++;
+            next_state_us = local_now + SIM_STATE_MS * 1000LL;
+        }
+
+        if (local_now >= next_report_us)
+        {
+            next_report_us = local_now + SIM_REPORT_MS * 1000LL;
+            if (hill_sync_is_synced(&sync))
+            {
+                // Stvarna greška: šta brdo misli da je vrijeme agregatora, naspram stvarnog
+                int64_t real_now = hill_now_us();
+                int64_t estimated_master_us = hill_sync_to_master(&sync.model, local_from_real(real_now));
+                printf("%s: sync rms %d us, max %u us, drift %+.2f ppm; true error %+lld us, worst tick %+lld us\n",
+                       name, hill_sync_rms_error_us(&sync), sync.max_error_us, hill_sync_drift_ppm(&sync),
+                       (long long)(estimated_master_us - real_now), (long long)worst_tick_error_us);
+                hill_sync_clear_stats(&sync);
+            }
+            else
+            {
+                printf("%s: not synced yet (%u beacons)\n", name, sync.beacons);
+            }
+        }
+    }
+    printf("%s: GAME OVER, team %d has won, worst tick error %+lld us\n", name, state.team,
+           (long long)worst_tick_error_us);
+    return 0;
+}
+
+// Ista pravila kao agregator u main/hill_link.c, poruke idu na stdout; sat računara je referenca
+static void run_aggregator(int start_in_s)
+{
+    static hill_scoreboard_t board;
+    uint8_t frame[HILL_FRAME_MAX];
+    int64_t last_summary_ms = now_ms();
+    int64_t last_beacon_ms = 0;
+    uint32_t invalid = 0;
+    hill_beacon_t beacon = {0};
+    bool beacon_unconfirmed = false;
+    int64_t previous_sent_us = 0;
+
+    if (start_in_s > 0)
+    {
+        beacon.start_id = 1;
+        beacon.start_us = hill_now_us() + start_in_s * 1000000LL;
+        printf("starting all hills in %d s\n", start_in_s);
+    }
+
+    hill_scoreboard_init(&board);
+    while (1)
+    {
+        int64_t received_us = 0;
+        int length = hill_udp_transport.receive(frame, sizeof(frame), 50, &received_us);
+        if (beacon_unconfirmed)
+        {
+            beacon_unconfirmed = false;
+            previous_sent_us = hill_udp_transport.sent_us();
+        }
+
+        hill_state_t state;
+        int index;
+        if (length > 0 && hill_proto_type(frame, length) == HILL_MSG_SYNC)
+        {
+            // Vlastiti beacon
+        }
+        else if (length > 0 && !hill_proto_decode(frame, length, &state))
+        {
+            invalid++;
+        }
+        else if (length > 0)
+        {
+            uint32_t changes = hill_scoreboard_update(&board, &state, now_ms(), &index);
+            if (changes & HILL_CHANGE_NEW)
+            {
+                printf("hill %s joined\n", state.name);
+            }
+            if (state.state == GAME_PLAYING && state.team >= 0 && (changes & (HILL_CHANGE_HOLDER | HILL_CHANGE_STATE)))
+            {
+                printf("team %d took hill %s, %u s left\n", state.team, state.name, state.remaining_s);
+            }
+            else if (state.state == GAME_FINISHED && (changes & HILL_CHANGE_STATE))
+            {
+                printf("GAME OVER on hill %s: team %d has won\n", state.name, state.team);
+            }
+        }
+
+        int offline = hill_scoreboard_expire(&board, now_ms(), SIM_OFFLINE_MS);
+        if (offline > 0)
+        {
+            printf("%d hills went offline\n", offline);
+        }
+
+        if (now_ms() - last_beacon_ms >= SIM_SYNC_INTERVAL_MS)
+        {
+            last_beacon_ms = now_ms();
+            beacon.previous_sent_us = previous_sent_us;
+            size_t beacon_length = hill_proto_encode_beacon(&beacon, frame, sizeof(frame));
+            hill_udp_transport.send(frame, beacon_length);
+            beacon_unconfirmed = true;
+            beacon.seq++;
+        }
+
+        if (now_ms() - last_summary_ms >= 10000)
+        {
+            last_summary_ms = now_ms();
+            printf("-- %u frames, %u duplicates, %u invalid, %u no room\n", board.frames, board.duplicates, invalid,
+                   board.full);
+            for (int i = 0; i < HILL_MAX; i++)
+            {
+                const hill_entry_t *entry = &board.hills[i];
+                if (!entry->used)
+                {
+                    continue;
+                }
+                char sync_error[16] = "not synced";
+                if (entry->state.sync_error_us != HILL_SYNC_ERROR_UNKNOWN)
+                {
+                    snprintf(sync_error, sizeof(sync_error), "%u us", entry->state.sync_error_us);
+                }
+                printf("   %-15s %-7s %-8s team %d, %u s left, clock error %s\n", entry->state.name,
+                       entry->online ? "online" : "offline", state_name(entry->state.state), entry->state.team,
+                       entry->state.remaining_s, sync_error);
+            }
+            for (int team = 0; team < SIM_TEAMS; team++)
+            {
+                printf("   team %d holds %d hills\n", team, hill_scoreboard_hills_held(&board, team));
+            }
+        }
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (strcmp(argv[1], "member") == 0 && argc < 3))
+    {
+        fprintf(stderr, "usage: %s member <name> [capture_every_s] [drift_ppm] [jitter_us] | aggregator [start_in_s]\n",
+                argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    srand((unsigned)hill_now_us());
+    if (hill_udp_transport.init() != 0)
+    {
+        perror("udp");
+        return 1;
+    }
+    if (strcmp(argv[1], "aggregator") == 0)
+    {
+        run_aggregator(argc > 2 ? atoi(argv[2]) : 5);
+        return 0;
+    }
+    int capture_every_s = argc > 3 ? atoi(argv[3]) : 7;
+    double drift_ppm = argc > 4 ? atof(argv[4]) : 0;
+    int jitter_us = argc > 5 ? atoi(argv[5]) : 0;
+    return run_member(argv[2], capture_every_s > 0 ? capture_every_s : 7, drift_ppm, jitter_us);
+}
@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+# Lokalni zamjenski server za ntfy.sh: ispisuje svaku poruku i broji zahtjeve i TCP konekcije.
+# Pokretanje: python3 tools/ntfy_standin.py [port]
+# Firmware:   idf.py -DNTFY_ENDPOINT=http://<ip racunara>:8080/koth build flash
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+stats = {'connections': 0, 'requests': 0}
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'  # Keep-alive, kao ntfy.sh
+
+    def setup(self):
+        super().setup()
+        stats['connections'] += 1
+
+    def reply(self):
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', '2')
+        self.end_headers()
+
+    def do_HEAD(self):
+        stats['requests'] += 1
+        self.reply()
+
+    def do_POST(self):
+        stats['requests'] += 1
+        body = self.rfile.read(int(self.headers.get('Content-Length', 0)))
+        print(f"[{stats['requests']} requests / {stats['connections']} connections] {body.decode(errors='replace')}")
+        self.reply()
+        self.wfile.write(b'{}')
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == '__main__':
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else 8080
+    print(f'Listening on :{port}')
+    ThreadingHTTPServer(('', port), Handler).serve_forever()
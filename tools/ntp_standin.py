@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+# Lokalni zamjenski NTP server: odgovara vremenom računara (plus pomak) i ispisuje svaki upit.
+# Pokretanje: sudo python3 tools/ntp_standin.py [pomak_u_sekundama]   (port 123 traži root)
+# Firmware:   idf.py -DSNTP_SERVER=<ip racunara> build flash
+# Pomak != 0 simulira korekciju sata; sat igre na uređaju se ne smije pomjeriti.
+import socket
+import struct
+import sys
+import time
+
+NTP_EPOCH_OFFSET = 2208988800  # Sekunde od 1900-01-01 do 1970-01-01
+
+
+def to_ntp(unix_time):
+    seconds = int(unix_time) + NTP_EPOCH_OFFSET
+    fraction = int((unix_time % 1) * (1 << 32))
+    return seconds, fraction
+
+
+def main():
+    offset = float(sys.argv[1]) if len(sys.argv) > 1 else 0.0
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('0.0.0.0', 123))
+    print(f'NTP stand-in on udp/123, offset {offset:+.3f} s')
+
+    requests = 0
+    while True:
+        data, address = sock.recvfrom(512)
+        receive = time.time() + offset
+        if len(data) < 48:
+            continue
+        requests += 1
+
+        # Klijentovo vrijeme slanja se vraća kao "originate", da klijent izračuna kašnjenje
+        originate = data[40:48]
+        transmit = time.time() + offset
+        reply = struct.pack('!BBbbII4s', (0 << 6) | (4 << 3) | 4, 1, 4, -20, 0, 0, b'LOCL')
+        reply += struct.pack('!II', *to_ntp(transmit))  # Reference
+        reply += originate
+        reply += struct.pack('!II', *to_ntp(receive))
+        reply += struct.pack('!II', *to_ntp(transmit))
+        sock.sendto(reply, address)
+        print(f'[{requests}] {address[0]} <- {time.strftime("%H:%M:%S", time.gmtime(transmit))}.{int(transmit % 1 * 1000):03d} UTC')
+
+
+if __name__ == '__main__':
+    main()